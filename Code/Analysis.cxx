@@ -29,6 +29,13 @@
 #include "DoubleEventRemoval.h"
 #include "Parameters.h"
 #include "Plots.h"
+#include "HistoMerger.h"
+#include "PlotRenderer.h"
+#ifdef USE_SVfit
+#include "SVfitPool.h"
+#include "SVfitStatistics.h"
+#include "SVFitStorage.h"
+#endif
 
 int main() {
 	Logger::Instance()->SetLevel(Logger::Info);
@@ -53,8 +60,8 @@ int main() {
 	std::vector<TString> Files, UncertType, UncertList, Analysis;
 	std::vector<double> UncertW;
 	bool thin, skim;
-	int mode, runtype;
-	TString mode_str, runType_str, histofile, skimfile, PlotStyle, PlotLabel;
+	int mode, runtype, mergeWorkers, plotWorkers, svfitWorkers;
+	TString mode_str, runType_str, svfitMode_str, svfitStatFile, histofile, skimfile, PlotStyle, PlotLabel;
 	double Lumi;
 	Par.GetVectorString("File:", Files);
 	Par.GetBool("Thin:", thin, "False");
@@ -69,6 +76,11 @@ int main() {
 	Par.GetDouble("Lumi:", Lumi, 1);
 	Par.GetString("PlotStyle:", PlotStyle, "style1");
 	Par.GetString("PlotLabel:", PlotLabel, "none");
+	Par.GetInt("MergeWorkers:", mergeWorkers, 1); // processes used to merge job outputs in RECONSTRUCT mode
+	Par.GetInt("PlotWorkers:", plotWorkers, 1);   // processes used to draw the plots of local jobs
+	Par.GetInt("SVfitWorkers:", svfitWorkers, 0); // processes running SVfit fits in the background (0: synchronous)
+	Par.GetString("SVfitMode:", svfitMode_str, "Fit"); // Fit/List (list missing SVfit results for SVfitFit.exe instead of fitting them)
+	Par.GetString("SVfitStatistics:", svfitStatFile, "SVfitStatistics.root"); // cost and convergence of the SVfit fits run
 	/////////////////////////////////////////////////
 	// Check Input
 	HistoConfig H;
@@ -117,6 +129,15 @@ int main() {
 	}
 	Plots P;
 	P.Set_Plot_Type(PlotStyle, PlotLabel);
+	PlotRenderer::SetDefaultWorkers(plotWorkers > 0 ? plotWorkers : 1);
+#ifdef USE_SVfit
+	SVfitPool::Instance().SetNWorkers(svfitWorkers > 0 ? svfitWorkers : 0);
+	svfitMode_str.ToUpper();
+	if (svfitMode_str == "LIST") {
+		Logger(Logger::Info) << "Using SVfitMode: LIST, missing SVfit results are listed for SVfitFit.exe" << std::endl;
+		SVFitStorage::SetRequestMode(true);
+	}
+#endif
 	//////////////////////////////////////////////////
 	// Configure Analysis
 	Selection_Factory SF;
@@ -182,6 +203,9 @@ int main() {
 			}
 			bool passed = false;
 			for (unsigned int j = 0; j < selections.size(); j++) {
+#ifdef USE_SVfit
+				SVfitStatistics::Instance().SetCategory(selections.at(j)->Get_Name());
+#endif
 				selections.at(j)->Event();
 				if (selections.at(j)->Passed())
 					passed = true;
@@ -192,6 +216,14 @@ int main() {
 			}
 		}
 		time(&afterLoop);
+#ifdef USE_SVfit
+		// results of fits still running are filled before the histograms are used
+		SVfitPool::Instance().Stop();
+		SVfitStatistics::Instance().Write(svfitStatFile);
+#endif
+		for (unsigned int j = 0; j < selections.size(); j++) {
+			selections.at(j)->EndOfEventLoop();
+		}
 		if (skim)
 			Ntp.SaveCloneTree();
 		if (ListOfFilesRead.at(0) == ListOfFilesRead.at(ListOfFilesRead.size() - 1))
@@ -213,25 +245,24 @@ int main() {
 	// Reconstruct Analysis from Stored Histograms
 	else if (mode == Selection_Base::RECONSTRUCT) {
 		Logger(Logger::Info) << "Reconstructing histograms: Loading files" << endl;
+		HistoMerger::SetDefaultWorkers(mergeWorkers > 0 ? mergeWorkers : 1);
 		for (unsigned int j = 0; j < selections.size(); j++) {
 			selections[j]->LoadResults(Files);
 		}
 		Logger(Logger::Info) << "Loading Files Complete" << std::endl;
 		if (runtype == Selection_Base::Local) {
-			Selection_Factory SF;
+			// systematics are streamed histogram by histogram from the job outputs,
+			// which are listed and merged only once (shared with LoadResults above)
 			for (unsigned int j = 0; j < selections.size(); j++) {
 				if (selections.at(j)->Get_SysType() == "default") {
 					for (unsigned int i = 0; i < UncertList.size(); i++) {
-						TString n = selections.at(j)->Get_Name();
-						Logger(Logger::Info) << "Adding Systematic Uncertainty " << UncertType.at(i) << endl;
-						Selection_Base *s = SF.Factory(selections.at(j)->Get_Analysis(), UncertList.at(i), mode, runtype, Lumi);
-						s->LoadResults(Files);
-						selections[j]->EvaluateSystematics(s, 1.0);
-						delete s;
+						Logger(Logger::Info) << "Adding Systematic Uncertainty " << UncertList.at(i) << endl;
+						selections[j]->EvaluateSystematics(UncertList.at(i), Files, 1.0);
 					}
 				}
 			}
 		}
+		HistoMerger::RemoveCachedFiles();
 	}
 	Logger(Logger::Verbose) << "Finishing" << endl;
 	for (unsigned int j = 0; j < selections.size(); j++) {
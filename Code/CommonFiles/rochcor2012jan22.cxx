@@ -194,130 +194,126 @@ rochcor2012::rochcor2012(int seed){
 }
 
 void rochcor2012::momcor_mc( TLorentzVector& mu, float charge, int runopt, float& qter){
-  
-  //sysdev == num : deviation = num
-
-  float ptmu = mu.Pt();
-  float muphi = mu.Phi();
-  float mueta = mu.Eta(); // same with mu.Eta() in Root
+  momcor_mc(mu, charge, runopt, qter, eran.Gaus(0.0, 1.0));
+}
 
+//  gaus: standard normal random number used for the resolution tuning of this muon.
+//        Pass a number from a per-muon random stream to make the correction reproducible.
+void rochcor2012::momcor_mc( TLorentzVector& mu, float charge, int runopt, float& qter, double gaus){
   float px = mu.Px();
   float py = mu.Py();
   float pz = mu.Pz();
   float e = mu.E();
-
-  int mu_phibin = phibin(muphi);
-  int mu_etabin = etabin(mueta);
-  
-  if(mu_phibin>=0 && mu_etabin>=0){
-    
-    float Mf = (mcor_bf[mu_phibin][mu_etabin] + mptsys_mc_dm[mu_phibin][mu_etabin]*mcor_bfer[mu_phibin][mu_etabin])/(mpavg[mu_phibin][mu_etabin]+mmavg[mu_phibin][mu_etabin]);
-    float Af = ((mcor_ma[mu_phibin][mu_etabin]+mptsys_mc_da[mu_phibin][mu_etabin]*mcor_maer[mu_phibin][mu_etabin]) - Mf*(mpavg[mu_phibin][mu_etabin]-mmavg[mu_phibin][mu_etabin]));     
-    
-    float cor = 1.0/(1.0 + 2.0*Mf + charge*Af*ptmu);
-    
-    //for the momentum tuning - eta,phi,Q correction
-    px *= cor;
-    py *= cor;
-    pz *= cor;
-    e  *= cor;
-    
-    float gscler = mgscl_stat;    
-    float gscl = (genm_smr/mrecm);
-    
-    px *= (gscl + gscler_mc_dev*gscler);
-    py *= (gscl + gscler_mc_dev*gscler);
-    pz *= (gscl + gscler_mc_dev*gscler);
-    e  *= (gscl + gscler_mc_dev*gscler);
-    
-    float momscl = sqrt(px*px + py*py)/ptmu;
-    
-    float tune = gsf[mu_etabin]*eran.Gaus(1.0,sf[mu_etabin]);
-    
-    px *= (tune); 
-    py *= (tune);  
-    pz *= (tune);  
-    e  *= (tune);   
-    
-    qter *= sqrt(momscl*momscl + (1.0-tune)*(1.0-tune));
-  }
-  
+  momcor(true, px, py, pz, e, charge, qter, gaus);
   mu.SetPxPyPzE(px,py,pz,e);
-  
 }
 
-
 void rochcor2012::momcor_data( TLorentzVector& mu, float charge, int runopt, float& qter){
-  
-  float ptmu = mu.Pt();
-
-  float muphi = mu.Phi();
-  float mueta = mu.Eta(); // same with mu.Eta() in Root
-
   float px = mu.Px();
   float py = mu.Py();
   float pz = mu.Pz();
   float e = mu.E();
-  
+  momcor(false, px, py, pz, e, charge, qter, 0.0);
+  mu.SetPxPyPzE(px,py,pz,e);
+}
+
+//-----------------------------------------------------------------------------------------------
+// batched correction of n muons given as structure of arrays (px, py, pz, e are corrected in place)
+//  gaus: n standard normal random numbers (only used for MC), may be NULL for data
+//  qter: n momentum uncertainty scale factors, updated in place (may be NULL)
+void rochcor2012::momcor_batch(bool isMC, unsigned n, float* px, float* py, float* pz, float* e, const float* charge, const double* gaus, float* qter){
+  for(unsigned i=0; i<n; i++){
+    float q = qter ? qter[i] : 1.0;
+    momcor(isMC, px[i], py[i], pz[i], e[i], charge[i], q, (isMC && gaus) ? gaus[i] : 0.0);
+    if(qter) qter[i] = q;
+  }
+}
+
+void rochcor2012::momcor(bool isMC, float& px, float& py, float& pz, float& e, float charge, float& qter, double gaus){
+
+  float ptmu = sqrt(px*px + py*py);
+  if(ptmu<=0) return;
+  float muphi = atan2(py, px);
+  float mueta = TMath::ASinH(pz/ptmu); // same with mu.Eta() in Root
+
   int mu_phibin = phibin(muphi);
   int mu_etabin = etabin(mueta);
 
-  if(mu_phibin>=0 && mu_etabin>=0){
-
-    float Mf = (dcor_bf[mu_phibin][mu_etabin]+mptsys_da_dm[mu_phibin][mu_etabin]*dcor_bfer[mu_phibin][mu_etabin])/(dpavg[mu_phibin][mu_etabin]+dmavg[mu_phibin][mu_etabin]);
-    float Af = ((dcor_ma[mu_phibin][mu_etabin]+mptsys_da_da[mu_phibin][mu_etabin]*dcor_maer[mu_phibin][mu_etabin]) - Mf*(dpavg[mu_phibin][mu_etabin]-dmavg[mu_phibin][mu_etabin]));     
-    
-    float cor = 1.0/(1.0 + 2.0*Mf + charge*Af*ptmu);
-    
-    px *= cor;
-    py *= cor;
-    pz *= cor;
-    e  *= cor;
-    
-    //after Z pt correction
-    float gscler = dgscl_stat;
-    float gscl = (genm_smr/drecm);
-    
-    px *= (gscl + gscler_da_dev*gscler);
-    py *= (gscl + gscler_da_dev*gscler);
-    pz *= (gscl + gscler_da_dev*gscler);
-    e  *= (gscl + gscler_da_dev*gscler);
-    
-    float momscl = sqrt(px*px + py*py)/ptmu;
+  if(mu_phibin<0 || mu_etabin<0) return;
+
+  float Mf, Af;
+  if(isMC){
+    Mf = (mcor_bf[mu_phibin][mu_etabin] + mptsys_mc_dm[mu_phibin][mu_etabin]*mcor_bfer[mu_phibin][mu_etabin])/(mpavg[mu_phibin][mu_etabin]+mmavg[mu_phibin][mu_etabin]);
+    Af = ((mcor_ma[mu_phibin][mu_etabin]+mptsys_mc_da[mu_phibin][mu_etabin]*mcor_maer[mu_phibin][mu_etabin]) - Mf*(mpavg[mu_phibin][mu_etabin]-mmavg[mu_phibin][mu_etabin]));
+  }
+  else{
+    Mf = (dcor_bf[mu_phibin][mu_etabin]+mptsys_da_dm[mu_phibin][mu_etabin]*dcor_bfer[mu_phibin][mu_etabin])/(dpavg[mu_phibin][mu_etabin]+dmavg[mu_phibin][mu_etabin]);
+    Af = ((dcor_ma[mu_phibin][mu_etabin]+mptsys_da_da[mu_phibin][mu_etabin]*dcor_maer[mu_phibin][mu_etabin]) - Mf*(dpavg[mu_phibin][mu_etabin]-dmavg[mu_phibin][mu_etabin]));
+  }
+
+  float cor = 1.0/(1.0 + 2.0*Mf + charge*Af*ptmu);
+
+  //for the momentum tuning - eta,phi,Q correction
+  //after Z pt correction
+  float gscl, gscler;
+  if(isMC){
+    gscler = mgscl_stat;
+    gscl = (genm_smr/mrecm) + gscler_mc_dev*gscler;
+  }
+  else{
+    gscler = dgscl_stat;
+    gscl = (genm_smr/drecm) + gscler_da_dev*gscler;
+  }
+  px *= cor; px *= gscl;
+  py *= cor; py *= gscl;
+  pz *= cor; pz *= gscl;
+  e  *= cor; e  *= gscl;
+
+  float momscl = sqrt(px*px + py*py)/ptmu;
+
+  if(isMC){
+    float tune = gsf[mu_etabin]*(1.0 + sf[mu_etabin]*gaus);
+    px *= (tune);
+    py *= (tune);
+    pz *= (tune);
+    e  *= (tune);
+    qter *= sqrt(momscl*momscl + (1.0-tune)*(1.0-tune));
+  }
+  else{
     qter *= momscl;
-    
   }
-  
-  mu.SetPxPyPzE(px,py,pz,e);
-  
 }
 
+//-----------------------------------------------------------------------------------------------
+// bin lookup: the bin is computed directly and then checked against the bin edges,
+// such that the result is identical to a scan over the edges
+
 int rochcor2012::phibin(float phi){
-  
-  int nphibin = -1;
-  
-  for(int i=0; i<8; i++){
-    if(-1*pi+(2.0*pi/8.0)*i <= phi && -1*pi+(2.0*pi/8.0)*(i+1) > phi){
-      nphibin = i;
-      break;
-    }
-  }
-  
-  return nphibin;
+
+  const double width = 2.0*pi/8.0;
+  if(!(phi >= -1*pi && phi < pi)) return -1;
+  int i = int((phi + pi)/width);
+  if(i > 7) i = 7;
+  if(i > 0 && -1*pi+width*i > phi) i--;
+  else if(i < 7 && -1*pi+width*(i+1) <= phi) i++;
+  if(-1*pi+width*i <= phi && -1*pi+width*(i+1) > phi) return i;
+  return -1;
 }
 
 int rochcor2012::etabin(float eta){
 
-  int nbin = -1;
-  
-  for(int i=0; i<8; i++){
-    if(netabin[i] <= eta && netabin[i+1] > eta){
-      nbin = i;
-      break;
-    }
+  if(!(eta >= netabin[0] && eta < netabin[8])) return -1;
+  // bins are 0.7 wide between -2.1 and 2.1, outer bins reach to +-2.4
+  int i;
+  if(eta < netabin[1]) i = 0;
+  else if(eta >= netabin[7]) i = 7;
+  else{
+    i = 1 + int((eta - netabin[1])/0.7);
+    if(i > 6) i = 6;
+    if(netabin[i] > eta) i--;
+    else if(netabin[i+1] <= eta) i++;
   }
-  
-  return nbin;
+  return i;
 }
 
 float rochcor2012::zptcor(float gzpt) {
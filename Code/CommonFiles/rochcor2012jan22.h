@@ -18,13 +18,17 @@ class rochcor2012 {
   ~rochcor2012();
   
   void momcor_mc(TLorentzVector&, float, int, float&);
+  void momcor_mc(TLorentzVector&, float, int, float&, double gaus);
   void momcor_data(TLorentzVector&, float, int, float&);
+  void momcor_batch(bool isMC, unsigned n, float* px, float* py, float* pz, float* e, const float* charge, const double* gaus, float* qter);
   
   float zptcor(float);
   int etabin(float);
   int phibin(float);
   
  private:
+
+  void momcor(bool isMC, float& px, float& py, float& pz, float& e, float charge, float& qter, double gaus);
   
   TRandom3 eran;
   TRandom3 sran;
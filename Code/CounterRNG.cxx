@@ -0,0 +1,103 @@
+/*
+ * CounterRNG.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CounterRNG.h"
+#include "TMath.h"
+
+namespace {
+	// Philox-4x32 constants
+	const UInt_t PHILOX_M0 = 0xD2511F53;
+	const UInt_t PHILOX_M1 = 0xCD9E8D57;
+	const UInt_t PHILOX_W0 = 0x9E3779B9;
+	const UInt_t PHILOX_W1 = 0xBB67AE85;
+	const unsigned PHILOX_ROUNDS = 10;
+
+	inline void mulhilo(UInt_t a, UInt_t b, UInt_t& hi, UInt_t& lo){
+		ULong64_t p = (ULong64_t)a * (ULong64_t)b;
+		hi = (UInt_t)(p >> 32);
+		lo = (UInt_t)p;
+	}
+}
+
+CounterRNG::CounterRNG(UInt_t seed):
+	seed_(seed),
+	run_(0),
+	lumi_(0),
+	event_(0)
+{
+	SetEvent(0, 0, 0);
+}
+
+CounterRNG::~CounterRNG() {
+}
+
+void CounterRNG::SetSeed(UInt_t seed){
+	seed_ = seed;
+	SetEvent(run_, lumi_, event_);
+}
+
+// The key is derived from (seed, run, lumi) by one Philox pass with a fixed key,
+// so that neighbouring runs/lumis do not end up with correlated keys.
+void CounterRNG::SetEvent(UInt_t run, UInt_t lumi, UInt_t event){
+	run_ = run;
+	lumi_ = lumi;
+	event_ = event;
+	UInt_t ctr[4] = {run, lumi, seed_, 0x5EED5EED};
+	const UInt_t fixedKey[2] = {0xA5A5A5A5, 0x3C3C3C3C};
+	Philox4x32(ctr, fixedKey);
+	key_[0] = ctr[0];
+	key_[1] = ctr[1];
+}
+
+void CounterRNG::Philox4x32(UInt_t ctr[4], const UInt_t key[2]){
+	UInt_t k0 = key[0];
+	UInt_t k1 = key[1];
+	for(unsigned r = 0; r < PHILOX_ROUNDS; r++){
+		UInt_t hi0, lo0, hi1, lo1;
+		mulhilo(PHILOX_M0, ctr[0], hi0, lo0);
+		mulhilo(PHILOX_M1, ctr[2], hi1, lo1);
+		UInt_t c0 = hi1 ^ ctr[1] ^ k0;
+		UInt_t c2 = hi0 ^ ctr[3] ^ k1;
+		ctr[0] = c0;
+		ctr[1] = lo1;
+		ctr[2] = c2;
+		ctr[3] = lo0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+}
+
+void CounterRNG::Generate(UInt_t out[4], UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw) const{
+	out[0] = event_;
+	out[1] = (collection << 24) | (idx & 0x00FFFFFF);
+	out[2] = variation;
+	out[3] = draw;
+	Philox4x32(out, key_);
+}
+
+// 53 bit uniform in (0,1]
+double CounterRNG::ToUniform(UInt_t hi, UInt_t lo){
+	ULong64_t x = ((ULong64_t)hi << 32) | (ULong64_t)lo;
+	return ((double)(x >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+}
+
+double CounterRNG::Uniform(UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw) const{
+	UInt_t out[4];
+	Generate(out, collection, idx, variation, draw);
+	return ToUniform(out[0], out[1]);
+}
+
+double CounterRNG::Normal(UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw) const{
+	UInt_t out[4];
+	Generate(out, collection, idx, variation, draw);
+	double u1 = ToUniform(out[0], out[1]);
+	double u2 = ToUniform(out[2], out[3]);
+	return sqrt(-2.0 * log(u1)) * cos(TMath::TwoPi() * u2);
+}
+
+double CounterRNG::Gaus(double mean, double sigma, UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw) const{
+	return mean + sigma * Normal(collection, idx, variation, draw);
+}
@@ -0,0 +1,60 @@
+/*
+ * CounterRNG.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Counter-based random number generator (Philox-4x32-10).
+ *
+ *      In contrast to TRandom3/gRandom this generator has no internal state
+ *      which advances with every call: each random number is a pure function
+ *      of a key and a counter. The key is built from the event identifiers
+ *      (run, lumi, event), the counter from the object collection, the
+ *      object index, the variation (systematic) and a draw index.
+ *      Thus the same object in the same event always gets the same random
+ *      number, independent of how often and in which order it is accessed,
+ *      and independent of the job/thread it is processed in.
+ *
+ *      Reference: Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11
+ */
+
+#ifndef COUNTERRNG_H_
+#define COUNTERRNG_H_
+
+#include "Rtypes.h"
+
+class CounterRNG {
+public:
+	// object collections used as part of the counter
+	enum Collection {Muon = 1, Electron, PFJet, PFTau, MET};
+	// variations used as part of the counter
+	enum Variation {Nominal = 0, Resolution, ResolutionDown, Scale, ScaleDown};
+
+	CounterRNG(UInt_t seed = 1234);
+	virtual ~CounterRNG();
+
+	// set event part of the key, has to be called once per event
+	void SetEvent(UInt_t run, UInt_t lumi, UInt_t event);
+	void SetSeed(UInt_t seed);
+
+	// uniform in (0,1]
+	double Uniform(UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw = 0) const;
+	// standard normal distributed number (Box-Muller, using one Philox block)
+	double Normal(UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw = 0) const;
+	// gaussian with given mean and sigma
+	double Gaus(double mean, double sigma, UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw = 0) const;
+
+	// raw Philox-4x32-10 block function: ctr is replaced by the random output
+	static void Philox4x32(UInt_t ctr[4], const UInt_t key[2]);
+
+private:
+	void Generate(UInt_t out[4], UInt_t collection, UInt_t idx, UInt_t variation, UInt_t draw) const;
+	static double ToUniform(UInt_t hi, UInt_t lo);
+
+	UInt_t seed_;
+	UInt_t run_;
+	UInt_t lumi_;
+	UInt_t event_;
+	UInt_t key_[2];
+};
+
+#endif /* COUNTERRNG_H_ */
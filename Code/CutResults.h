@@ -0,0 +1,101 @@
+/*
+ * CutResults.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Results of the cuts of a Selection (the pass vector). It is used like
+ *      a std::vector<bool>, but keeps a bit mask of the failed cuts up to
+ *      date whenever a result is set, so the cut flow and Passed(),
+ *      NMinusL(), ... do not loop over all cuts.
+ *      Bit i of the mask is set if cut i failed. Cuts beyond MaskBits are not
+ *      in the mask, only the number of them which failed is counted.
+ */
+
+#ifndef CUTRESULTS_H_
+#define CUTRESULTS_H_
+
+#include <vector>
+#include "Rtypes.h"
+
+class CutResults {
+public:
+	typedef ULong64_t Mask;
+	static const unsigned int MaskBits = 64;
+
+	// assignable result of one cut, like std::vector<bool>::reference
+	class reference {
+	public:
+		reference(CutResults& r, unsigned int i): r_(r), i_(i) {}
+		operator bool() const {return r_.values_[i_];}
+		reference& operator=(bool b){r_.set(i_, b); return *this;}
+		reference& operator=(const reference& o){return *this = (bool) o;}
+	private:
+		CutResults& r_;
+		unsigned int i_;
+	};
+	friend class reference;
+
+	CutResults(): failed_(0), nFailedBeyondMask_(0) {}
+
+	reference at(unsigned int i){values_.at(i); return reference(*this, i);}
+	bool at(unsigned int i) const {return values_.at(i);}
+	reference operator[](unsigned int i){return reference(*this, i);}
+	bool operator[](unsigned int i) const {return values_[i];}
+	unsigned int size() const {return values_.size();}
+	void push_back(bool b){values_.push_back(true); set(values_.size() - 1, b);}
+	void clear(){values_.clear(); failed_ = 0; nFailedBeyondMask_ = 0;}
+	operator const std::vector<bool>&() const {return values_;}
+
+	static Mask Bit(unsigned int i){return i < MaskBits ? ((Mask) 1) << i : 0;}
+	// failed cuts below MaskBits
+	Mask failedMask() const {return failed_;}
+	unsigned int nFailedBeyondMask() const {return nFailedBeyondMask_;}
+	unsigned int nFailed() const {return CountBits(failed_) + nFailedBeyondMask_;}
+	bool allPassed() const {return failed_ == 0 && nFailedBeyondMask_ == 0;}
+	// index of the first failed cut, size() if all passed
+	unsigned int firstFailed() const {
+		if(failed_ != 0) return LowestBit(failed_);
+		if(nFailedBeyondMask_ == 0) return values_.size();
+		unsigned int i = MaskBits;
+		while(values_[i]) i++;
+		return i;
+	}
+
+	static int CountBits(Mask m){
+#if defined(__GNUC__)
+		return __builtin_popcountll(m);
+#else
+		int n = 0;
+		for(; m; m &= m - 1) n++;
+		return n;
+#endif
+	}
+	// index of the lowest set bit, m must not be 0
+	static int LowestBit(Mask m){
+#if defined(__GNUC__)
+		return __builtin_ctzll(m);
+#else
+		int n = 0;
+		for(; !(m & 1); m >>= 1) n++;
+		return n;
+#endif
+	}
+
+private:
+	void set(unsigned int i, bool b){
+		if(values_[i] == b) return;
+		values_[i] = b;
+		if(i < MaskBits){
+			if(b) failed_ &= ~Bit(i);
+			else failed_ |= Bit(i);
+		}
+		else if(b) nFailedBeyondMask_--;
+		else nFailedBeyondMask_++;
+	}
+
+	std::vector<bool> values_;
+	Mask failed_;
+	unsigned int nFailedBeyondMask_;
+};
+
+#endif /* CUTRESULTS_H_ */
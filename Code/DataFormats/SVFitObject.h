@@ -16,6 +16,8 @@ class SVFitObject{
 	// and use SVfitProvider::makeObject(const SVfitStandaloneAlgorithm*, TString fitMethod)
 	// to create an instance of SVFitObject
 	friend class SVfitProvider;
+	// SVFitCache restores objects from its plain-data records
+	friend class SVFitCache;
 
  public:
 	// default constructor, creates an invalid object
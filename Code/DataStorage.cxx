@@ -1,14 +1,21 @@
 #include "SimpleFits/FitSoftware/interface/Logger.h"
 #include "DataStorage.h"
 #include "Parameters.h"
+#include "FileCache.h"
 #include <sys/types.h>
 #include <dirent.h>
 #include <errno.h>
 #include <fstream>
 #include "TString.h"
 #include "TSystem.h"
+#include "TObjArray.h"
+#include "TObjString.h"
 #include <iostream>
 #include <time.h>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
 
 int DataStorage::instanceCounter = 0;
 
@@ -33,33 +40,169 @@ DataStorage::~DataStorage(){
 int DataStorage::GetFile(TString key){
   Parameters Par; // assumes configured in Analysis.cxx
   TString gridsite="none";
+  TString cacheDir;
+  double cacheSize;
+  int nTransfers;
   std::vector<TString> Files;
   Par.GetVectorString(key,Files);
-  Par.GetString("GRIDSite:",gridsite);
+  Par.GetString("GRIDSite:",gridsite);   // srm host, or a local directory (starting with "/")
+  Par.GetString("DataCacheDir:", cacheDir, TString(gSystem->TempDirectory()) + "/DataStorageCache");
+  Par.GetDouble("DataCacheSizeGB:", cacheSize, 20);
+  Par.GetInt("DataTransfers:", nTransfers, 4);
 
   if(gridsite=="none" || Files.size()==0) return 0;
-  
+
+  FileCache cache(cacheDir, (Long64_t) (cacheSize * 1024 * 1024 * 1024));
+  // a cached copy is only used if the file on the grid has not changed since it was downloaded;
+  // files without known version are downloaded again and are cached for this job only
+  std::vector<TString> versions;
+  for(unsigned int i=0;i<Files.size();i++){
+    TString version = cache.isValid() ? SourceVersion(gridsite, Files.at(i)) : "";
+    if (cache.isValid() && version == ""){
+      Logger(Logger::Warning) << "Version of " << Files.at(i) << " is not available, the cached copy is not used." << std::endl;
+      version = "unverified:";
+      version += getpid();
+      version += ":";
+      version += (Long64_t) time(NULL);
+    }
+    versions.push_back(version);
+  }
+  std::vector<unsigned int> missing;
   for(unsigned int i=0;i<Files.size();i++){
 	TString inFile = assemblyFileName(i);
 	// check if file already exists
     ifstream check1(inFile);
     if (check1) Logger(Logger::Warning) << "File " << inFile << " already exists and will be overwritten." << std::endl;
+    if (!LinkCached(cache, Source(gridsite, Files.at(i)), versions.at(i), inFile)) missing.push_back(i);
+  }
+  Logger(Logger::Info) << Files.size() - missing.size() << " of " << Files.size() << " files for " << key << " found in " << cache.GetDir() << std::endl;
 
-    TString cmd1= "srmcp srm://" + gridsite + ":8443/" + Files.at(i) + " file:////" + mydir + "/" + inFile;
-    Logger(Logger::Info) << "calling shell command: "<< cmd1 << std::endl;
-    system(cmd1.Data());
-    filesToDelete.push_back(mydir + "/" + inFile);
-
-    // check if file was properly created
-    ifstream check2(inFile);
-    if(!check2){
-    	Logger(Logger::Error) << "Download of file " << inFile << " not successful." << std::endl;
-    	return 0;
+  if (missing.size() > 0){
+    TransferAll(cache, gridsite, Files, versions, missing, nTransfers > 0 ? nTransfers : 1);
+    for(unsigned int i=0;i<missing.size();i++){
+      TString inFile = assemblyFileName(missing.at(i));
+      if (!LinkCached(cache, Source(gridsite, Files.at(missing.at(i))), versions.at(missing.at(i)), inFile)){
+        Logger(Logger::Error) << "Download of file " << inFile << " not successful." << std::endl;
+        return 0;
+      }
     }
   }
+  cache.Evict();
   return Files.size();
 }
 
+TString DataStorage::Source(const TString& gridsite, const TString& file){
+  if (gridsite.BeginsWith("/")) return gridsite + "/" + file;
+  return "srm://" + gridsite + ":8443/" + file;
+}
+
+TString DataStorage::TransferCommand(const TString& gridsite, const TString& file, const TString& dest){
+  if (gridsite.BeginsWith("/")) return "cp " + Source(gridsite, file) + " " + dest;
+  return "srmcp " + Source(gridsite, file) + " file:////" + dest;
+}
+
+TString DataStorage::SourceVersion(const TString& gridsite, const TString& file){
+  if (gridsite.BeginsWith("/")){
+    struct stat st;
+    if (stat(Source(gridsite, file).Data(), &st) != 0) return "";
+    TString version;
+    version += (Long64_t) st.st_size;
+    version += ":";
+    version += (Long64_t) st.st_mtime;
+    return version;
+  }
+  // first line: <size> <path>, followed by "- Checksum value: ..." and "modified at:..."
+  TString listing = gSystem->GetFromPipe("srmls -l " + Source(gridsite, file) + " 2>/dev/null");
+  TObjArray *lines = listing.Tokenize("\n");
+  TString size, checksum, modified;
+  for (int i = 0; i < lines->GetEntriesFast(); i++){
+    TString line = ((TObjString*) lines->At(i))->GetString().Strip(TString::kBoth);
+    if (size == "" && line != ""){
+      size = line(0, line.First(' ') > 0 ? line.First(' ') : line.Length());
+      if (!size.IsDigit()) break;
+    }
+    else if (line.Contains("Checksum value:")) checksum = TString(line(line.Index("Checksum value:") + 15, line.Length())).Strip(TString::kBoth);
+    else if (line.BeginsWith("modified at:")) modified = TString(line(12, line.Length())).Strip(TString::kBoth);
+  }
+  delete lines;
+  if (size == "" || !size.IsDigit() || (checksum == "" && modified == "")) return "";
+  TString version = size + ":" + (checksum != "" ? checksum : modified);
+  version.ReplaceAll(" ", "_");
+  return version;
+}
+
+// download one file into the cache, unless another job is doing so or has done it
+bool DataStorage::Transfer(FileCache& cache, const TString& gridsite, const TString& file, const TString& version, const TString& inFile){
+  if (!cache.isValid()){
+    TString cmd = TransferCommand(gridsite, file, mydir + "/" + inFile);
+    Logger(Logger::Info) << "calling shell command: "<< cmd << std::endl;
+    system(cmd.Data());
+    return !gSystem->AccessPathName(mydir + "/" + inFile);
+  }
+  TString source = Source(gridsite, file);
+  int lock = cache.LockSource(source);
+  bool ok = (cache.Lookup(source, version) != "");
+  if (!ok){
+    TString tmp = cache.TempFile(source);
+    TString cmd = TransferCommand(gridsite, file, tmp);
+    Logger(Logger::Info) << "calling shell command: "<< cmd << std::endl;
+    system(cmd.Data());
+    ok = !gSystem->AccessPathName(tmp) && cache.Insert(source, version, tmp) != "";
+    if (!ok) gSystem->Unlink(tmp);
+  }
+  FileCache::Unlock(lock);
+  return ok;
+}
+
+// transfers run in forked processes, at most nTransfers at a time
+void DataStorage::TransferAll(FileCache& cache, const TString& gridsite, const std::vector<TString>& Files, const std::vector<TString>& versions, const std::vector<unsigned int>& idx, unsigned int nTransfers){
+  Logger(Logger::Info) << "Downloading " << idx.size() << " files with up to " << nTransfers << " parallel transfers" << std::endl;
+  // buffered output would be written by every transfer otherwise
+  fflush(stdout);
+  std::cout.flush();
+  std::vector<pid_t> running;
+  unsigned int next = 0;
+  while (next < idx.size() || running.size() > 0){
+    if (next < idx.size() && running.size() < nTransfers){
+      const TString& file = Files.at(idx.at(next));
+      const TString& version = versions.at(idx.at(next));
+      TString inFile = assemblyFileName(idx.at(next));
+      next++;
+      pid_t pid = fork();
+      if (pid == 0){
+        bool ok = Transfer(cache, gridsite, file, version, inFile);
+        fflush(stdout);
+        std::cout.flush();
+        _exit(ok ? 0 : 1);
+      }
+      if (pid < 0) Transfer(cache, gridsite, file, version, inFile);
+      else running.push_back(pid);
+      continue;
+    }
+    // transfers are checked by the caller
+    int status = 0;
+    waitpid(running.front(), &status, 0);
+    running.erase(running.begin());
+  }
+}
+
+// hard link the cached copy of source into the job directory (copy if on another file system)
+bool DataStorage::LinkCached(FileCache& cache, const TString& source, const TString& version, const TString& inFile){
+  TString local = mydir + "/" + inFile;
+  bool ok = false;
+  if (!cache.isValid()){
+    ok = !gSystem->AccessPathName(local); // downloaded directly
+  } else {
+    TString obj = cache.Lookup(source, version);
+    if (obj == "") return false;
+    gSystem->Unlink(local);
+    ok = (link(obj.Data(), local.Data()) == 0);
+    if (!ok && !gSystem->AccessPathName(obj)) ok = (gSystem->CopyFile(obj, local, kTRUE) == 0);
+  }
+  if (ok) filesToDelete.push_back(local);
+  return ok;
+}
+
 void DataStorage::StoreFile(TString File, TString savedFile){
   // put timestamp in output file
   savedFile.ReplaceAll("{DATE}", timeStamp(true, false));
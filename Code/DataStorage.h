@@ -4,6 +4,8 @@
 #include <vector>
 #include "TString.h"
 
+class FileCache;
+
 class DataStorage {
  public:
   DataStorage();
@@ -20,6 +22,15 @@ class DataStorage {
   // list of temporary files to be deleted
   std::vector<TString> filesToDelete;
 
+  // files are downloaded into a node-local FileCache ("DataCacheDir:", "DataCacheSizeGB:"),
+  // at most "DataTransfers:" at a time, and hard linked into the job directory;
+  // cached copies are keyed on the source and its SourceVersion
+  static TString Source(const TString& gridsite, const TString& file);
+  static TString TransferCommand(const TString& gridsite, const TString& file, const TString& dest);
+  bool Transfer(FileCache& cache, const TString& gridsite, const TString& file, const TString& version, const TString& inFile);
+  void TransferAll(FileCache& cache, const TString& gridsite, const std::vector<TString>& Files, const std::vector<TString>& versions, const std::vector<unsigned int>& idx, unsigned int nTransfers);
+  bool LinkCached(FileCache& cache, const TString& source, const TString& version, const TString& inFile);
+
  protected:
   TString inputFileName;
 
@@ -30,5 +41,9 @@ class DataStorage {
   int instance;
 
   TString assemblyFileName(unsigned int idx_File);
+
+  // size and modification time (srm: size and checksum, if available) of file on gridsite,
+  // "" if they cannot be obtained
+  static TString SourceVersion(const TString& gridsite, const TString& file);
 };
 #endif
@@ -0,0 +1,39 @@
+/*
+ * FNVHash.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      64 bit FNV-1a hash, used for the input hashes of stored results
+ *      (SVfitProvider, ProductStore producers, GlobalEventFit) and for the
+ *      signatures of KeyedRecordFiles. The hash is built by adding the bytes
+ *      of all inputs to Start, e.g.
+ *        ULong64_t h = FNVHash::Add(FNVHash::Start, &x, sizeof(x));
+ *      It identifies inputs, it is not meant to be secure.
+ */
+
+#ifndef FNVHASH_H_
+#define FNVHASH_H_
+
+#include <cstddef>
+#include "Rtypes.h"
+#include "TString.h"
+
+class FNVHash {
+public:
+	static const ULong64_t Start = 14695981039346656037ULL;
+
+	// add size bytes of data to hash h
+	static ULong64_t Add(ULong64_t h, const void* data, size_t size){
+		const unsigned char *c = (const unsigned char*) data;
+		for(size_t i=0; i<size; i++){
+			h ^= c[i];
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+	static ULong64_t Add(ULong64_t h, const TString& s){
+		return Add(h, s.Data(), s.Length());
+	}
+};
+
+#endif /* FNVHASH_H_ */
@@ -0,0 +1,148 @@
+/*
+ * FastHisto.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FastHisto.h"
+#include "TAxis.h"
+#include "TArrayD.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include <algorithm>
+#include <cstring>
+
+FastHisto::FastHisto():
+	nx(0), ny(0),
+	xmin(0), xmax(0),
+	ymin(0), ymax(0),
+	entries(0)
+{
+	memset(stats, 0, sizeof(stats));
+}
+
+FastHisto::FastHisto(int nx_, double xmin_, double xmax_):
+	nx(nx_), ny(0),
+	xmin(xmin_), xmax(xmax_),
+	ymin(0), ymax(0),
+	entries(0)
+{
+	Allocate();
+}
+
+FastHisto::FastHisto(int nx_, const double* xbins):
+	nx(nx_), ny(0),
+	xmin(xbins[0]), xmax(xbins[nx_]),
+	ymin(0), ymax(0),
+	xedges(xbins, xbins+nx_+1),
+	entries(0)
+{
+	Allocate();
+}
+
+FastHisto::FastHisto(int nx_, double xmin_, double xmax_, int ny_, double ymin_, double ymax_):
+	nx(nx_), ny(ny_),
+	xmin(xmin_), xmax(xmax_),
+	ymin(ymin_), ymax(ymax_),
+	entries(0)
+{
+	Allocate();
+}
+
+FastHisto::~FastHisto() {
+}
+
+FastHisto FastHisto::Like(const TH1& h){
+	FastHisto f;
+	const TAxis* x = h.GetXaxis();
+	f.nx = x->GetNbins();
+	f.xmin = x->GetXmin();
+	f.xmax = x->GetXmax();
+	if(x->GetXbins()->GetSize()>0) f.xedges.assign(x->GetXbins()->GetArray(), x->GetXbins()->GetArray()+f.nx+1);
+	if(h.GetDimension()==2){
+		const TAxis* y = h.GetYaxis();
+		f.ny = y->GetNbins();
+		f.ymin = y->GetXmin();
+		f.ymax = y->GetXmax();
+		if(y->GetXbins()->GetSize()>0) f.yedges.assign(y->GetXbins()->GetArray(), y->GetXbins()->GetArray()+f.ny+1);
+	}
+	else if(h.GetDimension()>2){
+		Logger(Logger::Error) << "FastHisto supports only 1D and 2D histograms. " << h.GetName() << " is treated as 1D." << std::endl;
+	}
+	f.Allocate();
+	return f;
+}
+
+void FastHisto::Allocate(){
+	int ncells = (nx+2) * (ny>0 ? ny+2 : 1);
+	sumw.assign(ncells, 0.);
+	sumw2.assign(ncells, 0.);
+	entries = 0;
+	memset(stats, 0, sizeof(stats));
+}
+
+int FastHisto::FindVariableBin(double v, const std::vector<double>& edges){
+	// edges[0] <= v < edges[n] is guaranteed by the caller
+	return std::upper_bound(edges.begin(), edges.end(), v) - edges.begin();
+}
+
+void FastHisto::FillN(int n, const double* x, const double* w){
+	if(w==NULL){
+		for(int i=0; i<n; i++){
+			int bin = FindBinX(x[i]);
+			sumw[bin] += 1.;
+			sumw2[bin] += 1.;
+			if(bin > 0 && bin <= nx) AddStats(x[i], 1.);
+		}
+	}
+	else{
+		for(int i=0; i<n; i++){
+			int bin = FindBinX(x[i]);
+			sumw[bin] += w[i];
+			sumw2[bin] += w[i]*w[i];
+			if(bin > 0 && bin <= nx) AddStats(x[i], w[i]);
+		}
+	}
+	entries += n;
+}
+
+void FastHisto::FillN(int n, const float* x, double w){
+	double w2 = w*w;
+	for(int i=0; i<n; i++){
+		int bin = FindBinX(x[i]);
+		sumw[bin] += w;
+		sumw2[bin] += w2;
+		if(bin > 0 && bin <= nx) AddStats(x[i], w);
+	}
+	entries += n;
+}
+
+bool FastHisto::AddTo(TH1& h) const{
+	if(h.GetNbinsX()!=nx || (ny>0 && h.GetNbinsY()!=ny)){
+		Logger(Logger::Error) << "Binning of " << h.GetName() << " does not match. Content not added." << std::endl;
+		return false;
+	}
+	if(entries==0) return true;
+	if(h.GetSumw2N()==0) h.Sumw2();
+	double oldEntries = h.GetEntries();
+	double hstats[13] = {0.}; // TH1::kNstat
+	h.GetStats(hstats);
+	TArrayD* hsumw2 = h.GetSumw2();
+	for(unsigned int k=0; k<sumw.size(); k++){
+		if(sumw2[k]==0) continue;
+		h.AddBinContent(k, sumw[k]);
+		hsumw2->fArray[k] += sumw2[k];
+	}
+	// moments of the unbinned fills, as TH1::Fill
+	int nstats = (ny>0) ? 7 : 4;
+	for(int i=0; i<nstats; i++) hstats[i] += stats[i];
+	h.PutStats(hstats);
+	h.SetEntries(oldEntries + entries);
+	return true;
+}
+
+void FastHisto::Reset(){
+	std::fill(sumw.begin(), sumw.end(), 0.);
+	std::fill(sumw2.begin(), sumw2.end(), 0.);
+	entries = 0;
+	memset(stats, 0, sizeof(stats));
+}
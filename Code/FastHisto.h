@@ -0,0 +1,103 @@
+/*
+ * FastHisto.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Lightweight histogram for the event loop.
+ *
+ *      Sum of weights and sum of squared weights are kept in contiguous
+ *      arrays with the same cell layout as ROOT (0: underflow, n+1: overflow,
+ *      2D: binx + (nx+2)*biny). For uniform binning the bin index is computed
+ *      directly (same assignment as TAxis::FindBin), variable binning uses a
+ *      binary search.
+ *      The moments of TH1::Fill (fTsumw, fTsumwx, ...) are accumulated for
+ *      fills inside the axis range, as ROOT does without TH1::StatOverflows.
+ *
+ *      The content is transferred to a TH1D/TH2D with AddTo(), which adds
+ *      bins and moments, i.e. mean and RMS are those of unbinned filling.
+ */
+
+#ifndef FASTHISTO_H_
+#define FASTHISTO_H_
+
+#include <vector>
+#include "TH1.h"
+
+class FastHisto {
+public:
+	FastHisto();
+	// 1D uniform / variable binning
+	FastHisto(int nx, double xmin, double xmax);
+	FastHisto(int nx, const double* xbins);
+	// 2D uniform binning
+	FastHisto(int nx, double xmin, double xmax, int ny, double ymin, double ymax);
+	virtual ~FastHisto();
+
+	// create a FastHisto with the binning of an existing ROOT histogram (1D or 2D)
+	static FastHisto Like(const TH1& h);
+
+	inline void Fill(double x, double w = 1.){
+		int bin = FindBinX(x);
+		sumw[bin] += w;
+		sumw2[bin] += w*w;
+		entries++;
+		if(bin > 0 && bin <= nx) AddStats(x, w);
+	}
+	inline void Fill(double x, double y, double w){
+		int binx = FindBinX(x), biny = FindBinY(y);
+		int bin = binx + (nx+2)*biny;
+		sumw[bin] += w;
+		sumw2[bin] += w*w;
+		entries++;
+		if(binx > 0 && binx <= nx && biny > 0 && biny <= ny){
+			AddStats(x, w);
+			stats[4] += w*y;
+			stats[5] += w*y*y;
+			stats[6] += w*x*y;
+		}
+	}
+	// batched filling, w == 0 means unit weights
+	void FillN(int n, const double* x, const double* w = 0);
+	void FillN(int n, const float* x, double w);
+
+	double GetBinContent(int bin) const {return sumw.at(bin);}
+	double GetBinError2(int bin) const {return sumw2.at(bin);}
+	double GetEntries() const {return entries;}
+	int    GetNcells() const {return sumw.size();}
+
+	// add content to ROOT histogram with identical binning
+	bool AddTo(TH1& h) const;
+	void Reset();
+
+private:
+	inline int FindBinX(double x) const {return FindBin(x, nx, xmin, xmax, xedges);}
+	inline int FindBinY(double y) const {return FindBin(y, ny, ymin, ymax, yedges);}
+	static inline int FindBin(double v, int n, double min, double max, const std::vector<double>& edges){
+		if(!(v >= min)) return 0;
+		if(v >= max) return n+1;
+		if(edges.empty()){
+			int bin = 1 + int(n*(v-min)/(max-min));
+			return bin > n ? n : bin;
+		}
+		return FindVariableBin(v, edges);
+	}
+	static int FindVariableBin(double v, const std::vector<double>& edges);
+	inline void AddStats(double x, double w){
+		stats[0] += w;
+		stats[1] += w*w;
+		stats[2] += w*x;
+		stats[3] += w*x*x;
+	}
+	void Allocate();
+
+	int nx, ny;
+	double xmin, xmax;
+	double ymin, ymax;
+	std::vector<double> xedges, yedges; // empty for uniform binning
+	std::vector<double> sumw;
+	std::vector<double> sumw2;
+	double entries;
+	double stats[7]; // layout of TH1::GetStats: sumw, sumw2, sumwx, sumwx2 (2D: sumwy, sumwy2, sumwxy)
+};
+
+#endif /* FASTHISTO_H_ */
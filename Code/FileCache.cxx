@@ -0,0 +1,166 @@
+/*
+ * FileCache.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FileCache.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TSystem.h"
+#include "TMD5.h"
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+namespace {
+struct Object {
+	TString path;
+	Long64_t size;
+	time_t used;
+	bool inUse;
+	bool operator<(const Object& o) const {return used < o.used;}
+};
+}
+
+FileCache::FileCache(TString dir, Long64_t maxBytes):
+	dir_(dir),
+	maxBytes_(maxBytes),
+	valid_(false)
+{
+	gSystem->mkdir(dir_ + "/obj", kTRUE);
+	gSystem->mkdir(dir_ + "/src", kTRUE);
+	valid_ = !gSystem->AccessPathName(dir_ + "/obj", kWritePermission) && !gSystem->AccessPathName(dir_ + "/src", kWritePermission);
+	if(!valid_) Logger(Logger::Warning) << "File cache " << dir_ << " is not writable, files are not cached." << std::endl;
+}
+
+FileCache::~FileCache() {
+}
+
+TString FileCache::MD5(const TString& s){
+	TMD5 md5;
+	md5.Update((const UChar_t*) s.Data(), s.Length());
+	md5.Final();
+	return md5.AsString();
+}
+
+TString FileCache::Lookup(const TString& source, const TString& version){
+	if(!valid_ || version == "") return "";
+	std::ifstream ref((dir_ + "/src/" + MD5(source)).Data());
+	std::string content, cachedVersion;
+	if(!(ref >> content >> cachedVersion)) return "";
+	if(version != cachedVersion.c_str()) return ""; // source has changed
+	TString obj = dir_ + "/obj/" + content.c_str();
+	// touch: least recently used objects are evicted first
+	if(utime(obj.Data(), NULL) != 0) return ""; // evicted
+	return obj;
+}
+
+TString FileCache::Insert(const TString& source, const TString& version, const TString& file){
+	if(!valid_) return "";
+	TMD5 *md5 = TMD5::FileChecksum(file);
+	if(md5 == NULL){
+		Logger(Logger::Error) << "Could not read " << file << std::endl;
+		return "";
+	}
+	TString content = md5->AsString();
+	delete md5;
+	TString obj = dir_ + "/obj/" + content;
+	TString ref = dir_ + "/src/" + MD5(source);
+	TString refTmp = ref + ".tmp";
+	refTmp += getpid();
+
+	int lock = Lock(dir_ + "/.lock");
+	bool ok = true;
+	if(gSystem->AccessPathName(obj)){
+		ok = rename(file.Data(), obj.Data()) == 0;
+	}
+	else{
+		gSystem->Unlink(file); // same content from another source
+		utime(obj.Data(), NULL);
+	}
+	if(ok){
+		std::ofstream out(refTmp.Data());
+		out << content << " " << version << std::endl;
+		out.close();
+		ok = !out.fail() && rename(refTmp.Data(), ref.Data()) == 0;
+	}
+	Unlock(lock);
+	if(!ok){
+		Logger(Logger::Error) << "Could not add " << source << " to file cache " << dir_ << std::endl;
+		gSystem->Unlink(refTmp);
+		return "";
+	}
+	return obj;
+}
+
+void FileCache::Evict(){
+	if(!valid_) return;
+	int lock = Lock(dir_ + "/.lock");
+	std::vector<Object> objects;
+	Long64_t total = 0;
+	void *d = gSystem->OpenDirectory(dir_ + "/obj");
+	const char *entry;
+	while(d != NULL && (entry = gSystem->GetDirEntry(d))){
+		TString name = entry;
+		if(name.BeginsWith(".")) continue; // also downloads in progress
+		Object o;
+		o.path = dir_ + "/obj/" + name;
+		struct stat st;
+		if(stat(o.path.Data(), &st) != 0) continue;
+		o.size = st.st_size;
+		o.used = st.st_mtime;
+		o.inUse = st.st_nlink > 1;
+		total += o.size;
+		objects.push_back(o);
+	}
+	if(d != NULL) gSystem->FreeDirectory(d);
+
+	std::sort(objects.begin(), objects.end());
+	unsigned int nRemoved = 0;
+	for(unsigned int i=0; i<objects.size() && total > maxBytes_; i++){
+		if(objects.at(i).inUse) continue; // removing it would not free space
+		if(gSystem->Unlink(objects.at(i).path) == 0){
+			total -= objects.at(i).size;
+			nRemoved++;
+		}
+	}
+	Unlock(lock);
+	if(nRemoved > 0) Logger(Logger::Info) << "Removed " << nRemoved << " files from file cache " << dir_ << ", " << total / (1024 * 1024) << " MB are cached" << std::endl;
+	if(total > maxBytes_) Logger(Logger::Warning) << "File cache " << dir_ << " exceeds its size, all remaining files are in use." << std::endl;
+}
+
+TString FileCache::TempFile(const TString& source){
+	TString tmp = dir_ + "/obj/.tmp_" + MD5(source) + "_";
+	tmp += getpid();
+	return tmp;
+}
+
+int FileCache::LockSource(const TString& source){
+	if(!valid_) return -1;
+	return Lock(dir_ + "/src/" + MD5(source) + ".lock");
+}
+
+int FileCache::Lock(const TString& file){
+	int fd = open(file.Data(), O_RDWR | O_CREAT, 0666);
+	if(fd < 0) return -1;
+	while(flock(fd, LOCK_EX) != 0){
+		if(errno != EINTR){
+			close(fd);
+			return -1;
+		}
+	}
+	return fd;
+}
+
+void FileCache::Unlock(int fd){
+	if(fd < 0) return;
+	flock(fd, LOCK_UN);
+	close(fd);
+}
@@ -0,0 +1,60 @@
+/*
+ * FileCache.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Node-local, content-addressed cache of files downloaded by DataStorage.
+ *
+ *      Layout of the cache directory:
+ *        obj/<md5 of content>     the cached files, shared by all sources with equal content
+ *        src/<md5 of source>      reference: md5 of the content and version of this source
+ *        src/<md5 of source>.lock held while the source is downloaded
+ *        .lock                    held while objects are added or evicted
+ *      A file is looked up by its source (e.g. the srm URL) and version (e.g.
+ *      size and modification time, see DataStorage::SourceVersion), a cached
+ *      copy of another version is not used and replaced by the next download.
+ *      The object is touched on each use and the least recently used objects are removed
+ *      when the cache exceeds its size. Objects which are still linked into a
+ *      job directory (link count > 1) are in use and never removed.
+ *      All locks are flock()s, i.e. they are released if a job dies.
+ */
+
+#ifndef FILECACHE_H_
+#define FILECACHE_H_
+
+#include "TString.h"
+#include "Rtypes.h"
+
+class FileCache {
+public:
+	FileCache(TString dir, Long64_t maxBytes);
+	virtual ~FileCache();
+
+	// path of the cached copy of this version of source, "" if it is not cached; marks it as recently used
+	TString Lookup(const TString& source, const TString& version);
+	// move file (e.g. a completed download) into the cache as copy of this version of source, returns its path in the cache
+	TString Insert(const TString& source, const TString& version, const TString& file);
+	// remove least recently used objects until the cache is below its maximum size
+	void Evict();
+
+	// exclusive lock on the download of source, to be released with Unlock (-1: failed)
+	int LockSource(const TString& source);
+	static void Unlock(int fd);
+
+	// temporary file name in the cache directory (same file system as the objects)
+	TString TempFile(const TString& source);
+
+	const TString& GetDir() const {return dir_;}
+	bool isValid() const {return valid_;}
+
+	static TString MD5(const TString& s);
+
+private:
+	int Lock(const TString& file);
+
+	TString dir_;
+	Long64_t maxBytes_;
+	bool valid_;
+};
+
+#endif /* FILECACHE_H_ */
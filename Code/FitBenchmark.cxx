@@ -0,0 +1,263 @@
+// Benchmark of the kinematic fits of a muon + 3-prong tau candidate (TauSolver, GlobalEventFit)
+//
+// Usage: FitBenchmark.exe [-n nSynthetic] [-s seed] [-k repetitions] [-w reference.txt] [-r reference.txt] [-t tolerance] [input files]
+//   input files: fit inputs recorded by the analysis with "FitBenchmarkRecord:", see FitInputRecorder.h
+//   -n  number of synthetic candidates, added to the recorded ones (default 1000 without input files)
+//   -s  seed of the synthetic candidates (default 1)
+//   -k  number of times every fit is repeated (default 1)
+//   -w  write the fit results to a reference file
+//   -r  compare the fit results to a reference file written with the same inputs, exit code 3 if they differ
+//   -t  relative tolerance of the comparison (default 1e-6, absolute for values below 1)
+// For every fit the latency (mean and quantiles), the number of iterations and the rate of
+// valid results are reported: converged GlobalEventFits, physical TauSolver solutions (the
+// solver always returns one, it is unphysical if the a1 is outside the maximal Gottfried-Jackson
+// angle of the flight direction). Optimisations of the fits are validated by comparing to a
+// reference written before the change:
+//   make benchmark-reference   (before the change: 1000 synthetic candidates, seed 1 -> benchmark/FitBenchmark_reference.txt)
+//   make benchmark-check       (after the change: same candidates, relative tolerance 1e-6)
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "SimpleFits/FitSoftware/interface/GlobalEventFit.h"
+#include "TROOT.h"
+#include "TString.h"
+#include "TMath.h"
+#include "FitInputRecorder.h"
+#include "TauSolver.h"
+#include "PDG_Var.h"
+
+namespace {
+typedef std::map<std::pair<std::string, unsigned int>, std::vector<double> > Reference;
+
+struct FitterResult {
+	std::string name;
+	std::vector<double> latency;    // seconds, all repetitions
+	std::vector<double> iterations; // empty if the fit does not iterate
+	std::string validLabel; // meaning of a valid result
+	unsigned int nFits, nValid;
+	std::vector<std::vector<double> > values; // outputs per candidate, first repetition
+};
+
+double now(){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+// Tau1 and Tau2 of the TauSolver, flight direction from the primary to the a1 vertex;
+// true if the solutions are physical
+bool solveTau(const FitInputRecorder::Record& r, std::vector<double>& out){
+	LorentzVectorParticle a1 = FitInputRecorder::A1(r);
+	TVector3 sv(r.a1Par[LorentzVectorParticle::vx], r.a1Par[LorentzVectorParticle::vy], r.a1Par[LorentzVectorParticle::vz]);
+	TVector3 direction = sv - FitInputRecorder::PV(r);
+	TauSolver solver(direction, a1.LV());
+	TLorentzVector tau1, tau2, nu1, nu2;
+	solver.SolvebyRotation(tau1, tau2, nu1, nu2, TauSolver::PZ);
+	double v[8] = {tau1.Px(), tau1.Py(), tau1.Pz(), tau1.E(), tau2.Px(), tau2.Py(), tau2.Pz(), tau2.E()};
+	out.assign(v, v + 8);
+	bool finite = true;
+	for(unsigned int i=0; i<out.size(); i++) finite = finite && TMath::Finite(out.at(i));
+	// maximal angle between a1 and tau: sin(theta_max) = (m_tau^2 - m_a1^2) / (2 m_tau p_a1)
+	double mTau = PDG_Var::Tau_mass(), mA1 = a1.LV().M(), pA1 = a1.LV().P();
+	double sinMax = (pA1 > 0) ? (mTau * mTau - mA1 * mA1) / (2 * mTau * pA1) : 0;
+	bool inCone = mA1 < mTau && (sinMax >= 1 || direction.Angle(a1.LV().Vect()) <= asin(sinMax));
+	return finite && inCone;
+}
+
+// as Ntuple_Controller::GlobalEventFit_MuTau3p
+bool fitEvent(const FitInputRecorder::Record& r, std::vector<double>& out, double& iterations){
+	GlobalEventFit GEF(FitInputRecorder::Muon(r), FitInputRecorder::A1(r), r.phiRes, FitInputRecorder::PV(r), FitInputRecorder::PVCov(r));
+	TPTRObject tptr = GEF.getTPTRObject();
+	GEFObject fit = GEF.Fit();
+	iterations = fit.getNiterations();
+	out.assign(5, 0.);
+	out.at(0) = fit.Fitconverged();
+	if(fit.Fitconverged()){
+		out.at(1) = fit.getChi2();
+		out.at(2) = fit.getNiterations();
+		out.at(3) = fit.getResonance().LV().M();
+		out.at(4) = fit.getTauH().LV().Pt();
+	}
+	return fit.Fitconverged();
+}
+
+FitterResult run(const std::string& name, const std::vector<FitInputRecorder::Record>& records, unsigned int repetitions){
+	FitterResult res;
+	res.name = name;
+	res.validLabel = (name == "TauSolver") ? "physical" : "converged";
+	res.nFits = 0;
+	res.nValid = 0;
+	res.values.resize(records.size());
+	res.latency.reserve(records.size() * repetitions);
+	std::vector<double> out;
+	for(unsigned int k=0; k<repetitions; k++){
+		for(unsigned int i=0; i<records.size(); i++){
+			double iterations = -1;
+			bool ok;
+			double start = now();
+			if(name == "TauSolver") ok = solveTau(records.at(i), out);
+			else ok = fitEvent(records.at(i), out, iterations);
+			res.latency.push_back(now() - start);
+			res.nFits++;
+			if(ok) res.nValid++;
+			if(iterations >= 0) res.iterations.push_back(iterations);
+			if(k == 0) res.values.at(i) = out;
+		}
+	}
+	return res;
+}
+
+double quantile(const std::vector<double>& sorted, double q){
+	if(sorted.size() == 0) return 0;
+	unsigned int i = std::min((unsigned int) (q * sorted.size()), (unsigned int) sorted.size() - 1);
+	return sorted.at(i);
+}
+
+void report(const FitterResult& res){
+	std::vector<double> l = res.latency;
+	std::sort(l.begin(), l.end());
+	double sum = 0;
+	for(unsigned int i=0; i<l.size(); i++) sum += l.at(i);
+	printf("%-16s %9u fits  latency [us]: mean %10.2f  p50 %10.2f  p90 %10.2f  p99 %10.2f  max %10.2f\n", res.name.c_str(), res.nFits,
+			l.size() > 0 ? 1e6 * sum / l.size() : 0., 1e6 * quantile(l, 0.5), 1e6 * quantile(l, 0.9), 1e6 * quantile(l, 0.99), l.size() > 0 ? 1e6 * l.back() : 0.);
+	if(res.iterations.size() > 0){
+		double sumIt = 0;
+		for(unsigned int i=0; i<res.iterations.size(); i++) sumIt += res.iterations.at(i);
+		printf("%-16s iterations: mean %.2f  max %.0f\n", "", sumIt / res.iterations.size(), *std::max_element(res.iterations.begin(), res.iterations.end()));
+	}
+	printf("%-16s %s: %.2f %%\n", "", res.validLabel.c_str(), res.nFits > 0 ? 100. * res.nValid / res.nFits : 0.);
+}
+
+bool writeReference(const TString& file, const std::vector<FitterResult>& results){
+	FILE *f = fopen(file.Data(), "w");
+	if(f == NULL){
+		Logger(Logger::Error) << "Could not create " << file << std::endl;
+		return false;
+	}
+	for(unsigned int j=0; j<results.size(); j++){
+		for(unsigned int i=0; i<results.at(j).values.size(); i++){
+			fprintf(f, "%s %u", results.at(j).name.c_str(), i);
+			const std::vector<double>& v = results.at(j).values.at(i);
+			for(unsigned int k=0; k<v.size(); k++) fprintf(f, " %.17g", v.at(k));
+			fprintf(f, "\n");
+		}
+	}
+	return fclose(f) == 0;
+}
+
+bool readReference(const TString& file, Reference& ref){
+	std::ifstream in(file.Data());
+	if(!in.good()){
+		Logger(Logger::Error) << "Could not open " << file << std::endl;
+		return false;
+	}
+	std::string line;
+	while(std::getline(in, line)){
+		std::istringstream s(line);
+		std::string name;
+		unsigned int i;
+		if(!(s >> name >> i)) continue;
+		std::vector<double>& v = ref[std::make_pair(name, i)];
+		std::string value;
+		while(s >> value) v.push_back(atof(value.c_str())); // also nan, inf
+	}
+	return true;
+}
+
+bool same(double a, double b, double tolerance){
+	if(TMath::IsNaN(a) || TMath::IsNaN(b)) return TMath::IsNaN(a) && TMath::IsNaN(b);
+	if(a == b) return true;
+	return fabs(a - b) <= tolerance * std::max(1., std::max(fabs(a), fabs(b)));
+}
+
+unsigned int compare(const Reference& ref, const FitterResult& res, double tolerance){
+	unsigned int nDiff = 0;
+	for(unsigned int i=0; i<res.values.size(); i++){
+		Reference::const_iterator it = ref.find(std::make_pair(res.name, i));
+		const std::vector<double>& v = res.values.at(i);
+		bool ok = it != ref.end() && it->second.size() == v.size();
+		for(unsigned int k=0; ok && k<v.size(); k++) ok = same(v.at(k), it->second.at(k), tolerance);
+		if(ok) continue;
+		if(nDiff < 10) Logger(Logger::Warning) << res.name << ": result of candidate " << i << " differs from the reference" << std::endl;
+		nDiff++;
+	}
+	return nDiff;
+}
+}
+
+int main(int argc, char* argv[]) {
+	Logger::Instance()->SetLevel(Logger::Info);
+	gROOT->SetBatch(kTRUE);
+
+	int nSynthetic = -1;
+	unsigned int seed = 1, repetitions = 1;
+	double tolerance = 1e-6;
+	TString writeRef, readRef;
+	std::vector<TString> inputs;
+	for (int i = 1; i < argc; i++) {
+		TString arg = argv[i];
+		if (arg == "-n" && i + 1 < argc) {
+			nSynthetic = atoi(argv[++i]);
+		} else if (arg == "-s" && i + 1 < argc) {
+			seed = atoi(argv[++i]);
+		} else if (arg == "-k" && i + 1 < argc) {
+			repetitions = atoi(argv[++i]);
+		} else if (arg == "-w" && i + 1 < argc) {
+			writeRef = argv[++i];
+		} else if (arg == "-r" && i + 1 < argc) {
+			readRef = argv[++i];
+		} else if (arg == "-t" && i + 1 < argc) {
+			tolerance = atof(argv[++i]);
+		} else if (arg.BeginsWith("-")) {
+			repetitions = 0;
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+	if (repetitions == 0 || nSynthetic < -1) {
+		Logger(Logger::Fatal) << "Usage: FitBenchmark.exe [-n nSynthetic] [-s seed] [-k repetitions] [-w reference.txt] [-r reference.txt] [-t tolerance] [input files]" << std::endl;
+		return 6;
+	}
+
+	std::vector<FitInputRecorder::Record> records;
+	for (unsigned int i = 0; i < inputs.size(); i++) {
+		if (!FitInputRecorder::Read(inputs.at(i), records)) return 1;
+	}
+	if (nSynthetic < 0) nSynthetic = (inputs.size() == 0) ? 1000 : 0;
+	unsigned int nRecorded = records.size();
+	FitInputRecorder::Generate(nSynthetic, seed, records);
+	Logger(Logger::Info) << "Benchmarking " << records.size() << " candidates (" << nRecorded << " recorded, " << nSynthetic << " synthetic), "
+			<< repetitions << " repetitions" << std::endl;
+
+	std::vector<FitterResult> results;
+	results.push_back(run("TauSolver", records, repetitions));
+	results.push_back(run("GlobalEventFit", records, repetitions));
+	for (unsigned int i = 0; i < results.size(); i++) report(results.at(i));
+
+	if (writeRef != "") {
+		if (!writeReference(writeRef, results)) return 1;
+		Logger(Logger::Info) << "Reference written to " << writeRef << std::endl;
+	}
+	if (readRef != "") {
+		Reference ref;
+		if (!readReference(readRef, ref)) return 1;
+		unsigned int nDiff = 0;
+		for (unsigned int i = 0; i < results.size(); i++) nDiff += compare(ref, results.at(i), tolerance);
+		if (nDiff > 0) {
+			Logger(Logger::Error) << nDiff << " results differ from " << readRef << " (tolerance " << tolerance << ")" << std::endl;
+			return 3;
+		}
+		Logger(Logger::Info) << "All results agree with " << readRef << " (tolerance " << tolerance << ")" << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * FitInputRecorder.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FitInputRecorder.h"
+#include "Parameters.h"
+#include "PDG_Var.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TRandom3.h"
+#include "TLorentzVector.h"
+#include "TVector2.h"
+#include "TMath.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+const char RecordMagic[8] = {'F', 'I', 'T', 'I', 'N', 'P', 'U', 'T'};
+const UInt_t RecordVersion = 1;
+
+void copyMatrix(double* dest, const TMatrixTBase<double>& m){
+	memcpy(dest, m.GetMatrixArray(), m.GetNoElements() * sizeof(double));
+}
+
+TMatrixTSym<double> symMatrix(const double* v, int n){
+	TMatrixTSym<double> m(n);
+	m.SetMatrixArray(v);
+	return m;
+}
+
+TMatrixT<double> parMatrix(const double* v, int n){
+	TMatrixT<double> m(n, 1);
+	m.SetMatrixArray(v);
+	return m;
+}
+}
+
+FitInputRecorder& FitInputRecorder::Instance(){
+	static FitInputRecorder rec;
+	return rec;
+}
+
+FitInputRecorder::FitInputRecorder():
+	file_(NULL),
+	opened_(false),
+	nRecords_(0)
+{
+}
+
+FitInputRecorder::~FitInputRecorder() {
+	if(file_ == NULL) return;
+	fclose(file_);
+	Logger(Logger::Info) << nRecords_ << " fit inputs recorded for FitBenchmark.exe" << std::endl;
+}
+
+void FitInputRecorder::Add(UInt_t run, UInt_t lumi, UInt_t event, TrackParticle muon, LorentzVectorParticle a1, double phiRes, TVector3 pv, TMatrixTSym<double> pvCov){
+	if(!opened_){
+		opened_ = true;
+		Parameters Par; // assumes configured in Analysis.cxx
+		TString fileName;
+		Par.GetString("FitBenchmarkRecord:", fileName, "");
+		if(fileName == "") return;
+		file_ = fopen(fileName.Data(), "wb");
+		Header h;
+		memset(&h, 0, sizeof(Header));
+		memcpy(h.magic, RecordMagic, sizeof(RecordMagic));
+		h.version = RecordVersion;
+		h.recordSize = sizeof(Record);
+		if(file_ == NULL || fwrite(&h, sizeof(Header), 1, file_) != 1){
+			Logger(Logger::Error) << "Could not create " << fileName << ", fit inputs are not recorded." << std::endl;
+			if(file_ != NULL) fclose(file_);
+			file_ = NULL;
+			return;
+		}
+		Logger(Logger::Info) << "Recording fit inputs to " << fileName << std::endl;
+	}
+	if(file_ == NULL) return;
+
+	Record r;
+	memset(&r, 0, sizeof(Record));
+	r.run = run;
+	r.lumi = lumi;
+	r.event = event;
+	copyMatrix(r.muonPar, muon.getParMatrix());
+	copyMatrix(r.muonCov, muon.getCovMatrix());
+	r.muonMass = muon.Mass();
+	r.muonCharge = muon.Charge();
+	r.muonB = muon.BField();
+	r.muonPdgid = muon.PDGID();
+	copyMatrix(r.a1Par, a1.getParMatrix());
+	copyMatrix(r.a1Cov, a1.getCovMatrix());
+	r.a1Charge = a1.Charge();
+	r.a1B = a1.BField();
+	r.a1Pdgid = a1.PDGID();
+	r.phiRes = phiRes;
+	pv.GetXYZ(r.pv);
+	copyMatrix(r.pvCov, pvCov);
+	if(fwrite(&r, sizeof(Record), 1, file_) == 1) nRecords_++;
+}
+
+bool FitInputRecorder::Read(TString file, std::vector<Record>& records){
+	FILE *f = fopen(file.Data(), "rb");
+	if(f == NULL){
+		Logger(Logger::Error) << "Could not open " << file << std::endl;
+		return false;
+	}
+	Header h;
+	if(fread(&h, sizeof(Header), 1, f) != 1 || memcmp(h.magic, RecordMagic, sizeof(RecordMagic)) != 0
+			|| h.version != RecordVersion || h.recordSize != sizeof(Record)){
+		Logger(Logger::Error) << file << " is not a fit input file of version " << RecordVersion << std::endl;
+		fclose(f);
+		return false;
+	}
+	Record r;
+	while(fread(&r, sizeof(Record), 1, f) == 1) records.push_back(r);
+	fclose(f);
+	return true;
+}
+
+void FitInputRecorder::Generate(unsigned int n, UInt_t seed, std::vector<Record>& records){
+	TRandom3 rnd(seed);
+	const double mTau = PDG_Var::Tau_mass();
+	const double mMu = 0.105658;
+	const double cTau = 0.00871;       // cm
+	const double cB = 0.0029979 * 3.8; // c * B [GeV/cm]
+	for(unsigned int i=0; i<n; i++){
+		Record r;
+		memset(&r, 0, sizeof(Record));
+		r.run = 1;
+		r.lumi = 1;
+		r.event = i + 1;
+
+		TVector3 pv(rnd.Gaus(0., 0.002), rnd.Gaus(0., 0.002), rnd.Gaus(0., 5.));
+		pv.GetXYZ(r.pv);
+		double pvErr[LorentzVectorParticle::NVertex] = {0.002, 0.002, 0.004};
+		for(int k=0; k<LorentzVectorParticle::NVertex; k++) r.pvCov[k * LorentzVectorParticle::NVertex + k] = pvErr[k] * pvErr[k];
+
+		// tau -> a1 nu, isotropic in the tau rest frame
+		TLorentzVector tau;
+		tau.SetPtEtaPhiM(rnd.Uniform(20., 60.), rnd.Uniform(-2.1, 2.1), rnd.Uniform(-TMath::Pi(), TMath::Pi()), mTau);
+		double mA1 = std::min(std::max(rnd.Gaus(1.23, 0.1), 0.8), 1.7);
+		double pStar = (mTau * mTau - mA1 * mA1) / (2 * mTau);
+		double cosTheta = rnd.Uniform(-1., 1.), phi = rnd.Uniform(0., 2 * TMath::Pi());
+		double sinTheta = sqrt(1 - cosTheta * cosTheta);
+		TLorentzVector a1;
+		a1.SetXYZM(pStar * sinTheta * cos(phi), pStar * sinTheta * sin(phi), pStar * cosTheta, mA1);
+		a1.Boost(tau.BoostVector());
+		TVector3 sv = pv + rnd.Exp(tau.P() / mTau * cTau) * tau.Vect().Unit();
+		r.a1Par[LorentzVectorParticle::vx] = sv.X();
+		r.a1Par[LorentzVectorParticle::vy] = sv.Y();
+		r.a1Par[LorentzVectorParticle::vz] = sv.Z();
+		r.a1Par[LorentzVectorParticle::px] = a1.Px();
+		r.a1Par[LorentzVectorParticle::py] = a1.Py();
+		r.a1Par[LorentzVectorParticle::pz] = a1.Pz();
+		r.a1Par[LorentzVectorParticle::m] = mA1;
+		const int nA1 = LorentzVectorParticle::NLorentzandVertexPar;
+		double a1Err[nA1] = {0.01, 0.01, 0.02, 0.01 * fabs(a1.Px()) + 0.01, 0.01 * fabs(a1.Py()) + 0.01, 0.01 * fabs(a1.Pz()) + 0.01, 0.01};
+		for(int k=0; k<nA1; k++) r.a1Cov[k * nA1 + k] = a1Err[k] * a1Err[k];
+		r.a1Charge = (rnd.Uniform() < 0.5) ? -1 : 1;
+		r.a1Pdgid = (r.a1Charge > 0) ? 20213 : -20213;
+		r.a1B = cB;
+
+		// muon roughly back to back with the tau in the transverse plane
+		TLorentzVector mu;
+		mu.SetPtEtaPhiM(rnd.Uniform(20., 40.), rnd.Uniform(-2.1, 2.1), tau.Phi() + TMath::Pi() + rnd.Gaus(0., 0.3), mMu);
+		r.muonCharge = -r.a1Charge;
+		r.muonPdgid = (r.muonCharge < 0) ? 13 : -13;
+		r.muonMass = mMu;
+		r.muonB = cB;
+		r.muonPar[TrackParticle::kappa] = r.muonCharge * cB / (2 * mu.Pt());
+		r.muonPar[TrackParticle::lambda] = TMath::PiOver2() - mu.Theta();
+		r.muonPar[TrackParticle::phi] = mu.Phi();
+		r.muonPar[TrackParticle::dxy] = rnd.Gaus(0., 0.003);
+		r.muonPar[TrackParticle::dz] = pv.Z() + rnd.Gaus(0., 0.005);
+		const int nMu = TrackParticle::NHelixPar;
+		double muErr[nMu] = {0.01 * fabs(r.muonPar[TrackParticle::kappa]), 0.001, 0.001, 0.003, 0.005};
+		for(int k=0; k<nMu; k++) r.muonCov[k * nMu + k] = muErr[k] * muErr[k];
+
+		// resonance direction, smeared by the recoil resolution
+		r.phiRes = TVector2::Phi_mpi_pi((mu + tau).Phi() + rnd.Gaus(0., 0.1));
+		records.push_back(r);
+	}
+}
+
+TrackParticle FitInputRecorder::Muon(const Record& r){
+	return TrackParticle(parMatrix(r.muonPar, TrackParticle::NHelixPar), symMatrix(r.muonCov, TrackParticle::NHelixPar),
+			r.muonPdgid, r.muonMass, r.muonCharge, r.muonB);
+}
+
+LorentzVectorParticle FitInputRecorder::A1(const Record& r){
+	return LorentzVectorParticle(parMatrix(r.a1Par, LorentzVectorParticle::NLorentzandVertexPar), symMatrix(r.a1Cov, LorentzVectorParticle::NLorentzandVertexPar),
+			r.a1Pdgid, r.a1Charge, r.a1B);
+}
+
+TVector3 FitInputRecorder::PV(const Record& r){
+	return TVector3(r.pv);
+}
+
+TMatrixTSym<double> FitInputRecorder::PVCov(const Record& r){
+	return symMatrix(r.pvCov, LorentzVectorParticle::NVertex);
+}
@@ -0,0 +1,77 @@
+/*
+ * FitInputRecorder.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Plain-data inputs of the kinematic fits of a muon + 3-prong tau candidate,
+ *      to replay them in FitBenchmark.exe.
+ *
+ *      If "FitBenchmarkRecord:" is set in Input.txt, the inputs of every
+ *      GlobalEventFit run by Ntuple_Controller::GlobalEventFit_MuTau3p are
+ *      written to that file (Header | Record records[]). The same inputs
+ *      also serve the TauSolver (a1 and flight direction). Generate() creates
+ *      synthetic candidates for benchmarks without recorded events.
+ */
+
+#ifndef FITINPUTRECORDER_H_
+#define FITINPUTRECORDER_H_
+
+#include <cstdio>
+#include <vector>
+#include "Rtypes.h"
+#include "TString.h"
+#include "TVector3.h"
+#include "TMatrixTSym.h"
+#include "SimpleFits/FitSoftware/interface/TrackParticle.h"
+#include "SimpleFits/FitSoftware/interface/LorentzVectorParticle.h"
+
+class FitInputRecorder {
+public:
+	struct Record {
+		UInt_t run;
+		UInt_t lumi;
+		UInt_t event;
+		Int_t muonPdgid;
+		double muonPar[TrackParticle::NHelixPar];
+		double muonCov[TrackParticle::NHelixPar * TrackParticle::NHelixPar];
+		double muonMass, muonCharge, muonB;
+		double a1Par[LorentzVectorParticle::NLorentzandVertexPar];
+		double a1Cov[LorentzVectorParticle::NLorentzandVertexPar * LorentzVectorParticle::NLorentzandVertexPar];
+		double a1Charge, a1B;
+		Int_t a1Pdgid;
+		Int_t reserved;
+		double phiRes; // direction of the recoil, see ZeroJet3Prong
+		double pv[LorentzVectorParticle::NVertex];
+		double pvCov[LorentzVectorParticle::NVertex * LorentzVectorParticle::NVertex];
+	};
+
+	static FitInputRecorder& Instance();
+	virtual ~FitInputRecorder();
+
+	// record the inputs of a GlobalEventFit, nothing is done without "FitBenchmarkRecord:"
+	void Add(UInt_t run, UInt_t lumi, UInt_t event, TrackParticle muon, LorentzVectorParticle a1, double phiRes, TVector3 pv, TMatrixTSym<double> pvCov);
+
+	static bool Read(TString file, std::vector<Record>& records);
+	// n synthetic Z/H -> tau_mu tau_3prong candidates with plausible kinematics and resolutions
+	static void Generate(unsigned int n, UInt_t seed, std::vector<Record>& records);
+
+	static TrackParticle Muon(const Record& r);
+	static LorentzVectorParticle A1(const Record& r);
+	static TVector3 PV(const Record& r);
+	static TMatrixTSym<double> PVCov(const Record& r);
+
+private:
+	FitInputRecorder();
+
+	struct Header {
+		char magic[8];
+		UInt_t version;
+		UInt_t recordSize;
+	};
+
+	FILE *file_;
+	bool opened_;
+	unsigned int nRecords_;
+};
+
+#endif /* FITINPUTRECORDER_H_ */
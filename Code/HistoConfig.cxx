@@ -18,13 +18,23 @@
 
 // Static var
 std::vector<int64_t>      HistoConfig::ID;
+std::map<int64_t,unsigned int> HistoConfig::IDIndex;
 std::vector<double>       HistoConfig::CS;
 std::vector<TString>      HistoConfig::HistoName;
 std::vector<TString>      HistoConfig::HistoLegend;
 std::vector<int>          HistoConfig::HistoColour;
 bool                      HistoConfig::loaded=false;
+std::vector<HistoConfig::Binning>      HistoConfig::LazyBinning;
+std::map<TString,unsigned int>         HistoConfig::LazyHistos;
+std::vector<bool>                      HistoConfig::TypeIsUsed;
+std::vector<HistoConfig::TypeListener*> HistoConfig::Listeners;
+int                                    HistoConfig::LazyThreshold=512;
+int                                    HistoConfig::SparseThreshold=10000;
 
-HistoConfig::HistoConfig(){
+HistoConfig::HistoConfig():
+  lastID(0),
+  lastType(-1)
+{
 }
 
 
@@ -37,6 +47,7 @@ bool HistoConfig::Load(TString Name_)
   if(loaded) return true;
   Logger(Logger::Verbose) << "HistoConfig::Load("<< Name_ <<")" << std::endl;
   ID.clear();
+  IDIndex.clear();
   HistoName.clear();
   HistoLegend.clear();
 
@@ -66,11 +77,8 @@ bool HistoConfig::Load(TString Name_)
     line >> type >> id >> cs >> name >> leg >> colour;
     type.ToLower();
     if(!type.Contains("histo:")) continue;
-    bool isnew=true;
-    for(unsigned int i=0; i<ID.size();i++){
-      if(ID.at(i)==id) isnew=false;
-    }
-    if(isnew){
+    if(IDIndex.find(id)==IDIndex.end()){
+      IDIndex[id]=ID.size();
       ID.push_back(id);
       CS.push_back(cs);
       HistoName.push_back(name);
@@ -79,6 +87,7 @@ bool HistoConfig::Load(TString Name_)
     }
   }
   input_file.close();
+  TypeIsUsed.assign(ID.size(),false);
   for(unsigned int i=0; i<ID.size();i++){
 	  Logger(Logger::Verbose) << "Histogram Data/MC ID: " << ID.at(i) << " CS: " << CS.at(i) << " Name: " <<  HistoName.at(i) << " Legend: " <<  HistoLegend.at(i) << " Colour: " << HistoColour.at(i) << std::endl;
   }
@@ -97,32 +106,24 @@ bool HistoConfig::GetHisto(bool isdata,int64_t id,unsigned int &histo){
   if(isdata){
     id=1;
   }
-  for(unsigned int i=0; i<ID.size(); i++){
-    if(ID.at(i)==id){
-      histo=i;
-      return true;
-    } 
-  }
-  return false;
+  int t=CachedType(id);
+  if(t<0) return false;
+  histo=t;
+  NotifyTypeUsed(t);
+  return true;
 }
 
 double HistoConfig::GetCrossSection(int64_t id){
-  for(unsigned int i=0; i<ID.size(); i++){
-    if(ID.at(i)==id){
-      return CS.at(i);
-    }
-  }
-  return 0;
+  int t=CachedType(id);
+  if(t<0) return 0;
+  return CS.at(t);
 }
 
 bool HistoConfig::SetCrossSection(int64_t id, double xsec){
-	for(unsigned int i=0; i<ID.size(); i++){
-		if(ID.at(i)==id){
-			CS.at(i) = xsec;
-			return true;
-	    }
-	}
-	return false;
+	int t=FindType(id);
+	if(t<0) return false;
+	CS.at(t) = xsec;
+	return true;
 }
 
 void HistoConfig::GetHistoInfo(std::vector<int64_t> &types,std::vector<float> &CrossSectionandAcceptance,std::vector<TString> &legend,std::vector<int> &colour){
@@ -152,8 +153,15 @@ TString HistoConfig::GetLeg(unsigned int i){
 std::vector<TH1D> HistoConfig::GetTH1D(TString name,TString title, int nbins, double min, double max, TString xaxis, TString yaxis){
   std::vector<TH1D> histos;
   Logger(Logger::Verbose) << "Adding TH1D " << name << " " << title << std::endl;
+  bool lazy = isLazy(nbins+2);
+  if(lazy){
+    Binning b; b.dim=1;
+    b.n[0]=nbins; b.min[0]=min; b.max[0]=max;
+    BookLazy(name,b);
+  }
   for(unsigned int i=0;i<HistoName.size();i++){
-    histos.push_back(TH1D(name+HistoName.at(i),HistoLegend.at(i),nbins,min,max));
+    if(lazy && !isTypeUsed(i)) histos.push_back(TH1D(name+HistoName.at(i),HistoLegend.at(i),1,min,max));
+    else histos.push_back(TH1D(name+HistoName.at(i),HistoLegend.at(i),nbins,min,max));
     histos.at(i).Sumw2();
     histos.at(i).SetXTitle(xaxis);
     histos.at(i).SetYTitle(yaxis);
@@ -164,8 +172,16 @@ std::vector<TH1D> HistoConfig::GetTH1D(TString name,TString title, int nbins, do
 std::vector<TH1D> HistoConfig::GetTH1D(TString name,TString title, int nbins, double* xbins, TString xaxis,TString yaxis){
   std::vector<TH1D> histos;
   Logger(Logger::Verbose) << "Adding TH1D " << name << " " << title << std::endl;
+  bool lazy = isLazy(nbins+2);
+  if(lazy){
+    Binning b; b.dim=1;
+    b.n[0]=nbins; b.min[0]=xbins[0]; b.max[0]=xbins[nbins];
+    b.edges.assign(xbins,xbins+nbins+1);
+    BookLazy(name,b);
+  }
   for(unsigned int i=0;i<HistoName.size();i++){
-    histos.push_back(TH1D(name+HistoName.at(i),HistoLegend.at(i),nbins,xbins));
+    if(lazy && !isTypeUsed(i)) histos.push_back(TH1D(name+HistoName.at(i),HistoLegend.at(i),1,xbins[0],xbins[nbins]));
+    else histos.push_back(TH1D(name+HistoName.at(i),HistoLegend.at(i),nbins,xbins));
     histos.at(i).Sumw2();
     histos.at(i).SetXTitle(xaxis);
     histos.at(i).SetYTitle(yaxis);
@@ -177,8 +193,16 @@ std::vector<TH2D> HistoConfig::GetTH2D(TString name,TString title,int nbinsx, do
 				       int nbinsy, double miny, double maxy, TString xaxis, TString yaxis){
   std::vector<TH2D> histos;
   Logger(Logger::Verbose) << "Adding TH2D " << name << " " << title << std::endl;
+  bool lazy = isLazy((nbinsx+2)*(nbinsy+2));
+  if(lazy){
+    Binning b; b.dim=2;
+    b.n[0]=nbinsx; b.min[0]=minx; b.max[0]=maxx;
+    b.n[1]=nbinsy; b.min[1]=miny; b.max[1]=maxy;
+    BookLazy(name,b);
+  }
   for(unsigned int i=0;i<HistoName.size();i++){
-    histos.push_back(TH2D(name+HistoName.at(i),HistoLegend.at(i),nbinsx,minx,maxx, nbinsy,miny,maxy));
+    if(lazy && !isTypeUsed(i)) histos.push_back(TH2D(name+HistoName.at(i),HistoLegend.at(i),1,minx,maxx,1,miny,maxy));
+    else histos.push_back(TH2D(name+HistoName.at(i),HistoLegend.at(i),nbinsx,minx,maxx, nbinsy,miny,maxy));
     histos.at(i).Sumw2();
     histos.at(i).SetXTitle(xaxis);
     histos.at(i).SetYTitle(yaxis);
@@ -192,8 +216,17 @@ std::vector<TH3F> HistoConfig::GetTH3F(TString name,TString title, int nbinsx, d
 
   std::vector<TH3F> histos;
   Logger(Logger::Verbose) << "Adding TH2D " << name << " " << title << std::endl;
+  bool lazy = isLazy((nbinsx+2)*(nbinsy+2)*(nbinsz+2));
+  if(lazy){
+    Binning b; b.dim=3;
+    b.n[0]=nbinsx; b.min[0]=minx; b.max[0]=maxx;
+    b.n[1]=nbinsy; b.min[1]=miny; b.max[1]=maxy;
+    b.n[2]=nbinsz; b.min[2]=minz; b.max[2]=maxz;
+    BookLazy(name,b);
+  }
   for(unsigned int i=0;i<HistoName.size();i++){
-    histos.push_back(TH3F(name+HistoName.at(i),HistoLegend.at(i),nbinsx,minx,maxx,nbinsy,miny,maxy,nbinsz,minz,maxz));
+    if(lazy && !isTypeUsed(i)) histos.push_back(TH3F(name+HistoName.at(i),HistoLegend.at(i),1,minx,maxx,1,miny,maxy,1,minz,maxz));
+    else histos.push_back(TH3F(name+HistoName.at(i),HistoLegend.at(i),nbinsx,minx,maxx,nbinsy,miny,maxy,nbinsz,minz,maxz));
     histos.at(i).Sumw2();
     histos.at(i).SetXTitle(xaxis);
     histos.at(i).SetYTitle(yaxis);
@@ -202,15 +235,105 @@ std::vector<TH3F> HistoConfig::GetTH3F(TString name,TString title, int nbinsx, d
   return histos;
 }
 
+//lazy allocation
+bool HistoConfig::isLazy(int ncells){
+  return LazyThreshold>0 && ncells>LazyThreshold;
+}
 
+void HistoConfig::BookLazy(TString name, const Binning& b){
+  LazyBinning.push_back(b);
+  for(unsigned int i=0;i<HistoName.size();i++){
+    LazyHistos[name+HistoName.at(i)]=LazyBinning.size()-1;
+  }
+}
 
-bool HistoConfig::hasID(int64_t id_){
-  for(unsigned int i=0; i<ID.size();i++){
-    if(ID.at(i)==id_) return true;
+void HistoConfig::RegisterTypeListener(TypeListener* l){
+  if(std::find(Listeners.begin(),Listeners.end(),l)!=Listeners.end()) return;
+  Listeners.push_back(l);
+  // inform about types which have been used before registration
+  for(unsigned int t=0;t<TypeIsUsed.size();t++){
+    if(TypeIsUsed.at(t)) l->TypeUsed(t);
+  }
+}
+
+void HistoConfig::RemoveTypeListener(TypeListener* l){
+  std::vector<TypeListener*>::iterator it=std::find(Listeners.begin(),Listeners.end(),l);
+  if(it!=Listeners.end()) Listeners.erase(it);
+}
+
+void HistoConfig::NotifyTypeUsed(unsigned int t){
+  if(t>=TypeIsUsed.size() || TypeIsUsed.at(t)) return;
+  TypeIsUsed.at(t)=true;
+  Logger(Logger::Verbose) << "Allocating histograms of type " << t << " (" << HistoName.at(t) << ")" << std::endl;
+  for(unsigned int i=0;i<Listeners.size();i++){
+    Listeners.at(i)->TypeUsed(t);
   }
+}
+
+// all axes are compared: placeholders are 1x1(x1), a family may have a single bin along some axes
+bool HistoConfig::hasBinning(const TH1& h, const Binning& b){
+  if(h.GetNbinsX()!=b.n[0]) return false;
+  if(b.dim>=2 && h.GetNbinsY()!=b.n[1]) return false;
+  if(b.dim>=3 && h.GetNbinsZ()!=b.n[2]) return false;
+  return true;
+}
+
+bool HistoConfig::isPlaceholder(const TH1& h){
+  std::map<TString,unsigned int>::const_iterator it=LazyHistos.find(h.GetName());
+  if(it==LazyHistos.end()) return false;
+  return !hasBinning(h,LazyBinning.at(it->second));
+}
+
+// resize a placeholder to its final binning, returns false if h is no placeholder
+bool HistoConfig::Materialize(TH1& h){
+  std::map<TString,unsigned int>::const_iterator it=LazyHistos.find(h.GetName());
+  if(it==LazyHistos.end()) return false;
+  const Binning& b=LazyBinning.at(it->second);
+  if(hasBinning(h,b)) return false;
+  if(h.GetEntries()>0){
+    Logger(Logger::Warning) << "Histogram " << h.GetName() << " was filled before its type was used. Content is dropped." << std::endl;
+  }
+  if(b.dim==1){
+    if(b.edges.size()>0) h.SetBins(b.n[0],&b.edges.at(0));
+    else h.SetBins(b.n[0],b.min[0],b.max[0]);
+  }
+  else if(b.dim==2){
+    h.SetBins(b.n[0],b.min[0],b.max[0],b.n[1],b.min[1],b.max[1]);
+  }
+  else{
+    h.SetBins(b.n[0],b.min[0],b.max[0],b.n[1],b.min[1],b.max[1],b.n[2],b.min[2],b.max[2]);
+  }
+  h.Reset();
+  return true;
+}
+
+//sparse merging
+bool HistoConfig::isSparse(const TH1& h){
+  if(h.GetDimension()==3) return true;
+  if(h.GetDimension()==2) return SparseThreshold>0 && (h.GetNbinsX()+2)*(h.GetNbinsY()+2)>SparseThreshold;
   return false;
 }
 
+bool HistoConfig::hasID(int64_t id_){
+  return CachedType(id_)>=0;
+}
+
+// type index of id, -1 if unknown
+int HistoConfig::FindType(int64_t id){
+  std::map<int64_t,unsigned int>::const_iterator it=IDIndex.find(id);
+  if(it==IDIndex.end()) return -1;
+  return it->second;
+}
+
+// as FindType, but remembers the last id: within one input file all events have the same id
+int HistoConfig::CachedType(int64_t id){
+  if(lastType<0 || id!=lastID){
+    lastID=id;
+    lastType=FindType(id);
+  }
+  return lastType;
+}
+
 
 int HistoConfig::GetID(unsigned int i){
   if(ID.size()>i) return ID.at(i);
@@ -218,10 +341,7 @@ int HistoConfig::GetID(unsigned int i){
 }
 
 int HistoConfig::GetType(int64_t id){
-	for(unsigned int i=0; i<ID.size(); i++){
-	    if(ID.at(i)==id){
-	    	return i;
-	    }
-	}
-	return -1;
+	int t=CachedType(id);
+	if(t>=0) NotifyTypeUsed(t);
+	return t;
 }
@@ -2,6 +2,7 @@
 #define HistoConfig_h
 
 #include <vector>
+#include <map>
 #include "TString.h"
 #include "TH1D.h"
 #include "TH2D.h"
@@ -11,6 +12,14 @@
 class HistoConfig {
 
  public:
+  // Interface for objects which hold histogram families and need to know
+  // when a type is used for the first time (see lazy allocation below)
+  class TypeListener {
+  public:
+    virtual ~TypeListener(){}
+    virtual void TypeUsed(unsigned int t)=0;
+  };
+
   HistoConfig();
   virtual ~HistoConfig();
 
@@ -39,12 +48,56 @@ class HistoConfig {
   int GetType(int64_t id);
   static bool isloaded() { return loaded; }
 
+  // Lazy allocation of large histograms:
+  // Histograms with more than LazyThreshold cells are booked as 1-bin placeholders for all
+  // types which have not been used yet. The binning is stored once per family. A type counts
+  // as used once it is returned by GetHisto or GetType; then all registered listeners are
+  // notified and can materialize (rebin) their histograms of this type.
+  static void SetLazyThreshold(int ncells){ LazyThreshold = ncells; }
+  static void RegisterTypeListener(TypeListener* l);
+  static void RemoveTypeListener(TypeListener* l);
+  static bool isTypeUsed(unsigned int t){ return t < TypeIsUsed.size() && TypeIsUsed.at(t); }
+  bool isPlaceholder(const TH1& h);
+  bool Materialize(TH1& h);
+
+  // Sparse merging of large 2D/3D histograms:
+  // When combining job outputs, 3D histograms and 2D histograms with more than SparseThreshold
+  // cells are accumulated in a SparseHisto and converted to the dense ROOT histogram only
+  // once the combined result is needed (see Selection::LoadResults).
+  static void SetSparseThreshold(int ncells){ SparseThreshold = ncells; }
+  static bool isSparse(const TH1& h);
+
  private:
+  struct Binning {
+    int dim;
+    int n[3];
+    double min[3], max[3];
+    std::vector<double> edges; // variable binning, only 1d
+  };
+  bool isLazy(int ncells);
+  static bool hasBinning(const TH1& h, const Binning& b);
+  void BookLazy(TString name, const Binning& b);
+  void NotifyTypeUsed(unsigned int t);
+  static int FindType(int64_t id);
+  int CachedType(int64_t id);
+
+  static std::vector<Binning>      LazyBinning;
+  static std::map<TString,unsigned int> LazyHistos; // histogram name -> LazyBinning index
+  static std::vector<bool>         TypeIsUsed;
+  static std::vector<TypeListener*> Listeners;
+  static int                       LazyThreshold;
+  static int                       SparseThreshold;
+
   static std::vector<int64_t>      ID;
+  static std::map<int64_t,unsigned int> IDIndex; // ID -> type, built once in Load
   static std::vector<double>       CS;
   static std::vector<TString>      HistoName;
   static std::vector<TString>      HistoLegend;
   static std::vector<int>          HistoColour;
   static bool                      loaded;
+
+  // last resolved id of this instance, the id only changes between input files
+  int64_t                          lastID;
+  int                              lastType;
 };
 #endif
@@ -0,0 +1,75 @@
+// Standalone merging of job output files, see HistoMerger.h
+//
+// Usage: HistoMerge.exe [-j nWorkers] [-p pattern] <output.root> <input files or directories>
+//   -j  number of worker processes (default 1)
+//   -p  for directories: merge the first file containing pattern (default ".root")
+//
+//        HistoMerge.exe --watch [-i seconds] [-n cycles] [-s seconds] [-p pattern] [-j nWorkers] <state.root> <directory>
+//   folds job outputs appearing in directory into state.root, see IncrementalMerger.h
+//   -i  seconds between two scans of directory (default 300)
+//   -n  stop after n scans (default 0: until <state.root>.stop exists)
+//   -s  seconds an output has to be unchanged before it is merged (default 60)
+
+#include <cstdlib>
+#include <vector>
+
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TROOT.h"
+#include "TString.h"
+#include "HistoMerger.h"
+#include "IncrementalMerger.h"
+
+int main(int argc, char* argv[]) {
+	Logger::Instance()->SetLevel(Logger::Info);
+	gROOT->SetBatch(kTRUE);
+
+	unsigned int nWorkers = 1;
+	bool watch = false;
+	unsigned int interval = 300, cycles = 0, settle = 60;
+	TString pattern = ".root";
+	TString output;
+	std::vector<TString> inputs;
+	for (int i = 1; i < argc; i++) {
+		TString arg = argv[i];
+		if (arg == "-j" && i + 1 < argc) {
+			nWorkers = atoi(argv[++i]);
+		} else if (arg == "-p" && i + 1 < argc) {
+			pattern = argv[++i];
+		} else if (arg == "--watch") {
+			watch = true;
+		} else if (arg == "-i" && i + 1 < argc) {
+			interval = atoi(argv[++i]);
+		} else if (arg == "-n" && i + 1 < argc) {
+			cycles = atoi(argv[++i]);
+		} else if (arg == "-s" && i + 1 < argc) {
+			settle = atoi(argv[++i]);
+		} else if (output == "") {
+			output = arg;
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+	if (output == "" || inputs.size() == 0 || (watch && inputs.size() != 1)) {
+		Logger(Logger::Fatal) << "Usage: HistoMerge.exe [-j nWorkers] [-p pattern] <output.root> <input files or directories>" << std::endl;
+		Logger(Logger::Fatal) << "       HistoMerge.exe --watch [-i seconds] [-n cycles] [-s seconds] [-p pattern] [-j nWorkers] <state.root> <directory>" << std::endl;
+		return 6;
+	}
+
+	if (watch) {
+		HistoMerger::SetDefaultWorkers(nWorkers);
+		IncrementalMerger merger(output, pattern);
+		merger.SetSettleTime(settle);
+		merger.Load();
+		merger.Watch(inputs.at(0), interval, cycles);
+		Logger(Logger::Info) << output << " contains the outputs of " << merger.GetNJobs() << " jobs" << std::endl;
+		return 0;
+	}
+
+	HistoMerger merger(nWorkers);
+	if (!merger.Merge(HistoMerger::ResolveFiles(inputs, pattern), output)) {
+		Logger(Logger::Fatal) << "Merging into " << output << " failed" << std::endl;
+		return 1;
+	}
+	Logger(Logger::Info) << "Merged " << merger.GetNGoodFiles() << " files into " << output << ", NBadFiles=" << merger.GetBadFiles().size() << std::endl;
+	return merger.GetBadFiles().size() > 0 ? 2 : 0;
+}
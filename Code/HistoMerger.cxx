@@ -0,0 +1,310 @@
+/*
+ * HistoMerger.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "HistoMerger.h"
+#include "HistoConfig.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TSystem.h"
+#include <fstream>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+
+unsigned int HistoMerger::DefaultWorkers = 1;
+std::map<TString, std::vector<TString> > HistoMerger::DirectoryCache;
+std::map<TString, HistoMerger::CachedMerge> HistoMerger::MergeCache;
+
+HistoMerger::HistoMerger(unsigned int nWorkers_):
+	nWorkers(nWorkers_ > 0 ? nWorkers_ : 1),
+	nGoodFiles(0)
+{
+}
+
+HistoMerger::~HistoMerger() {
+}
+
+void HistoMerger::HistoSet::Clear(){
+	for(unsigned int i=0; i<histos.size(); i++) delete histos.at(i);
+	names.clear();
+	histos.clear();
+	std::vector<SparseHisto>().swap(sparse);
+	sources.clear();
+	index.clear();
+}
+
+std::vector<TString> HistoMerger::ResolveFiles(const std::vector<TString>& files, TString pattern){
+	std::vector<TString> resolved;
+	for(unsigned int f=0; f<files.size(); f++){
+		TString file = files.at(f);
+		if(!file.Contains(".root")){
+			std::map<TString, std::vector<TString> >::iterator dir = DirectoryCache.find(file);
+			if(dir == DirectoryCache.end()){
+				dir = DirectoryCache.insert(std::make_pair(file, std::vector<TString>())).first;
+				DIR *dp = opendir(file.Data());
+				if(dp == NULL){
+					Logger(Logger::Error) << "error number " << errno << " opening " << file << std::endl;
+				}
+				else{
+					struct dirent *dirp;
+					while((dirp = readdir(dp)) != NULL){
+						dir->second.push_back(dirp->d_name);
+					}
+					closedir(dp);
+				}
+			}
+			for(unsigned int i=0; i<dir->second.size(); i++){
+				if(dir->second.at(i).Contains(pattern)){
+					file += dir->second.at(i);
+					break;
+				}
+			}
+		}
+		resolved.push_back(file);
+	}
+	return resolved;
+}
+
+bool HistoMerger::MergeCached(TString name, const std::vector<TString>& files, TString& output,
+		unsigned int& nGood, std::vector<TString>& bad){
+	std::map<TString, CachedMerge>::iterator it = MergeCache.find(name);
+	if(it == MergeCache.end()){
+		CachedMerge m;
+		// job-unique and outside of the job output directories (see ResolveFiles)
+		m.file = TString(gSystem->TempDirectory()) + "/MERGED_" + name + "_";
+		m.file += getpid();
+		m.file += ".root";
+		HistoMerger merger;
+		m.ok = merger.Merge(files, m.file);
+		m.nGood = merger.GetNGoodFiles();
+		m.bad = merger.GetBadFiles();
+		it = MergeCache.insert(std::make_pair(name, m)).first;
+	}
+	output = it->second.file;
+	nGood = it->second.nGood;
+	bad = it->second.bad;
+	return it->second.ok;
+}
+
+void HistoMerger::RemoveCachedFiles(){
+	for(std::map<TString, CachedMerge>::iterator it = MergeCache.begin(); it != MergeCache.end(); it++){
+		gSystem->Unlink(it->second.file);
+	}
+	MergeCache.clear();
+}
+
+bool HistoMerger::Merge(const std::vector<TString>& files, TString output){
+	nGoodFiles = 0;
+	badFiles.clear();
+	unsigned int nw = nWorkers < files.size() ? nWorkers : files.size();
+	if(nw > 1 && MergeInWorkers(files, output, nw)) return true;
+
+	HistoSet result;
+	MergeRange(files, 0, files.size(), result);
+	bool ok = Write(result, output);
+	result.Clear();
+	return ok;
+}
+
+// split files into nw chunks, each merged by a forked process into a partial file,
+// and reduce the partial files; false if this failed and nothing was counted
+bool HistoMerger::MergeInWorkers(const std::vector<TString>& files, TString output, unsigned int nw){
+	Logger(Logger::Info) << "Merging " << files.size() << " files into " << output << " with " << nw << " workers" << std::endl;
+	std::vector<TString> partial;
+	std::vector<pid_t> pids;
+	for(unsigned int w=0; w<nw; w++){
+		TString part = output;
+		part.ReplaceAll(".root", "");
+		part += ".part";
+		part += w;
+		part += ".root";
+		partial.push_back(part);
+		pid_t pid = fork();
+		if(pid == 0){
+			// worker: merge its chunk, report the file bookkeeping in a text file next to the result
+			HistoMerger worker(1);
+			HistoSet s;
+			worker.MergeRange(files, files.size()*w/nw, files.size()*(w+1)/nw, s);
+			bool ok = Write(s, part);
+			std::ofstream log((part + ".log").Data());
+			log << worker.nGoodFiles << std::endl;
+			for(unsigned int i=0; i<worker.badFiles.size(); i++) log << worker.badFiles.at(i) << std::endl;
+			log.close();
+			_exit(ok ? 0 : 1);
+		}
+		if(pid < 0) Logger(Logger::Error) << "fork failed for merge worker " << w << std::endl;
+		pids.push_back(pid);
+	}
+
+	bool ok = true;
+	for(unsigned int w=0; w<pids.size(); w++){
+		int status = 1;
+		if(pids.at(w) > 0) waitpid(pids.at(w), &status, 0);
+		if(pids.at(w) <= 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+	}
+
+	unsigned int good = 0;
+	std::vector<TString> bad;
+	for(unsigned int w=0; w<partial.size() && ok; w++){
+		std::ifstream log((partial.at(w) + ".log").Data());
+		std::string line;
+		if(!std::getline(log, line)){
+			ok = false;
+			break;
+		}
+		good += atoi(line.c_str());
+		while(std::getline(log, line)){
+			if(!line.empty()) bad.push_back(line.c_str());
+		}
+	}
+
+	if(ok){
+		HistoMerger reducer(1);
+		HistoSet result;
+		reducer.MergeRange(partial, 0, partial.size(), result);
+		ok = reducer.badFiles.empty() && Write(result, output);
+		result.Clear();
+	}
+	for(unsigned int w=0; w<partial.size(); w++){
+		gSystem->Unlink(partial.at(w));
+		gSystem->Unlink(partial.at(w) + ".log");
+	}
+	if(!ok){
+		Logger(Logger::Warning) << "Parallel merge into " << output << " failed, merging sequentially." << std::endl;
+		return false;
+	}
+	nGoodFiles = good;
+	badFiles = bad;
+	return true;
+}
+
+// pairwise tree reduction of files [begin,end) into out (out has to be empty)
+void HistoMerger::MergeRange(const std::vector<TString>& files, unsigned int begin, unsigned int end, HistoSet& out){
+	if(end <= begin) return;
+	if(end - begin == 1){
+		if(ReadFile(files.at(begin), out)){
+			nGoodFiles++;
+		}
+		else{
+			badFiles.push_back(files.at(begin));
+			Logger(Logger::Warning) << files.at(begin) << " NOT OPENED" << std::endl;
+		}
+		return;
+	}
+	unsigned int mid = begin + (end - begin)/2;
+	HistoSet right;
+	MergeRange(files, begin, mid, out);
+	MergeRange(files, mid, end, right);
+	Add(out, right);
+	right.Clear();
+}
+
+// read all histograms of file in the order of its key list, s has to be empty
+bool HistoMerger::ReadFile(TString file, HistoSet& s){
+	TFile *f = TFile::Open(file, "READ");
+	if(f == NULL) return false;
+	if(!f->IsOpen() || f->IsZombie()){
+		delete f;
+		return false;
+	}
+	Logger(Logger::Verbose) << "HistoMerger::ReadFile " << file << std::endl;
+	TIter next(f->GetListOfKeys());
+	TKey *key;
+	while((key = (TKey*) next())){
+		TClass *cl = TClass::GetClass(key->GetClassName());
+		if(cl == NULL || !cl->InheritsFrom(TH1::Class())) continue;
+		// keys are sorted by decreasing cycle: only the newest cycle is used
+		if(s.index.find(key->GetName()) != s.index.end()) continue;
+		TH1 *h = (TH1*) key->ReadObj();
+		if(h == NULL) continue;
+		h->SetDirectory(0);
+		s.index[key->GetName()] = s.names.size();
+		s.names.push_back(key->GetName());
+		if(HistoConfig::isSparse(*h)){
+			s.sparse.push_back(SparseHisto::Like(*h));
+			s.sparse.back().Add(*h);
+			s.sources.push_back(file);
+			s.histos.push_back(NULL);
+			delete h;
+		}
+		else{
+			s.sparse.push_back(SparseHisto());
+			s.sources.push_back("");
+			s.histos.push_back(h);
+		}
+	}
+	f->Close();
+	delete f;
+	return true;
+}
+
+// add b to a; histograms only present in b are moved to a
+void HistoMerger::Add(HistoSet& a, HistoSet& b){
+	for(unsigned int i=0; i<b.names.size(); i++){
+		TH1 *h = b.histos.at(i);
+		std::map<TString, unsigned int>::const_iterator it = a.index.find(b.names.at(i));
+		if(it == a.index.end()){
+			a.index[b.names.at(i)] = a.names.size();
+			a.names.push_back(b.names.at(i));
+			a.histos.push_back(h);
+			a.sparse.push_back(SparseHisto());
+			a.sparse.back().Swap(b.sparse.at(i));
+			a.sources.push_back(b.sources.at(i));
+			b.histos.at(i) = NULL;
+			continue;
+		}
+		unsigned int j = it->second;
+		if(a.histos.at(j) != NULL && h != NULL) a.histos.at(j)->Add(h, 1.000);
+		else if(a.histos.at(j) != NULL) b.sparse.at(i).AddTo(*a.histos.at(j));
+		else if(h != NULL) a.sparse.at(j).Add(*h);
+		else a.sparse.at(j).Add(b.sparse.at(i));
+	}
+}
+
+bool HistoMerger::Write(const HistoSet& s, TString output){
+	TFile f(output, "RECREATE");
+	if(f.IsZombie()){
+		Logger(Logger::Error) << "Could not open " << output << " for writing." << std::endl;
+		return false;
+	}
+	bool ok = true;
+	std::map<TString, TFile*> sources;
+	for(unsigned int i=0; i<s.names.size(); i++){
+		if(s.histos.at(i) != NULL){
+			f.cd();
+			s.histos.at(i)->Write(s.names.at(i));
+			continue;
+		}
+		// sparse: dense only while it is written
+		TFile*& src = sources[s.sources.at(i)];
+		if(src == NULL) src = TFile::Open(s.sources.at(i), "READ");
+		TH1 *proto = (src != NULL && src->IsOpen()) ? (TH1*) src->Get(s.names.at(i)) : NULL;
+		if(proto == NULL){
+			Logger(Logger::Error) << "Could not read " << s.names.at(i) << " from " << s.sources.at(i) << ", it is not written to " << output << std::endl;
+			ok = false;
+			continue;
+		}
+		f.cd();
+		TH1 *h = (TH1*) proto->Clone(s.names.at(i));
+		delete proto;
+		h->Reset();
+		s.sparse.at(i).AddTo(*h);
+		h->Write(s.names.at(i));
+		delete h;
+	}
+	for(std::map<TString, TFile*>::iterator it = sources.begin(); it != sources.end(); it++){
+		if(it->second == NULL) continue;
+		it->second->Close();
+		delete it->second;
+	}
+	f.Close();
+	return ok;
+}
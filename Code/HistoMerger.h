@@ -0,0 +1,91 @@
+/*
+ * HistoMerger.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Merges the histograms of many job output files into one file.
+ *
+ *      The key list of each input file is read once and all histograms are
+ *      read in that order, i.e. no lookup by name is done per histogram.
+ *      Histograms with equal names are added in a pairwise tree reduction
+ *      (file 0+1, 2+3, then (0+1)+(2+3), ...), so at most log2(N) sets of
+ *      histograms are held in memory at the same time. 3D histograms and
+ *      large 2D histograms (HistoConfig::isSparse) are kept in a SparseHisto
+ *      during the reduction and only converted to the dense ROOT histogram,
+ *      one at a time, when the result is written.
+ *      With more than one worker the input files are split into contiguous
+ *      chunks which are merged by forked worker processes into temporary
+ *      files; these partial results are then reduced in the parent process.
+ *
+ *      Used by Selection::LoadResults and by the standalone HistoMerge.exe.
+ */
+
+#ifndef HISTOMERGER_H_
+#define HISTOMERGER_H_
+
+#include <vector>
+#include <map>
+#include "TString.h"
+#include "TH1.h"
+#include "SparseHisto.h"
+
+class HistoMerger {
+public:
+	HistoMerger(unsigned int nWorkers = DefaultWorkers);
+	virtual ~HistoMerger();
+
+	// merge all histograms of files into output (RECREATE), false if output could not be written
+	bool Merge(const std::vector<TString>& files, TString output);
+
+	unsigned int GetNGoodFiles() const {return nGoodFiles;}
+	const std::vector<TString>& GetBadFiles() const {return badFiles;}
+
+	// entries without ".root" are treated as directories and replaced by the first file
+	// in them whose name contains pattern; unresolved entries are returned unchanged.
+	// Each directory is listed only once per process.
+	static std::vector<TString> ResolveFiles(const std::vector<TString>& files, TString pattern);
+
+	// merge files into a temporary MERGED_<name>_<pid>.root only once per process: later calls with
+	// the same name return the stored result (used when several selections need the same job outputs)
+	static bool MergeCached(TString name, const std::vector<TString>& files, TString& output,
+			unsigned int& nGood, std::vector<TString>& bad);
+	static void RemoveCachedFiles();
+
+	// number of worker processes used by default (set e.g. from "MergeWorkers:" in Input.txt)
+	static void SetDefaultWorkers(unsigned int n){DefaultWorkers = n > 0 ? n : 1;}
+	static unsigned int GetDefaultWorkers(){return DefaultWorkers;}
+
+private:
+	// histograms of one (partial) merge result, owned by the set
+	struct HistoSet {
+		std::vector<TString> names;
+		std::vector<TH1*> histos;          // NULL for sparse histograms
+		std::vector<SparseHisto> sparse;   // content of sparse histograms
+		std::vector<TString> sources;      // sparse: file to read class, binning and titles from
+		std::map<TString, unsigned int> index; // name -> position
+		void Clear();
+	};
+
+	void MergeRange(const std::vector<TString>& files, unsigned int begin, unsigned int end, HistoSet& out);
+	bool ReadFile(TString file, HistoSet& s);
+	static void Add(HistoSet& a, HistoSet& b);
+	static bool Write(const HistoSet& s, TString output);
+	bool MergeInWorkers(const std::vector<TString>& files, TString output, unsigned int nw);
+
+	unsigned int nWorkers;
+	unsigned int nGoodFiles;
+	std::vector<TString> badFiles;
+
+	struct CachedMerge {
+		bool ok;
+		TString file;
+		unsigned int nGood;
+		std::vector<TString> bad;
+	};
+
+	static unsigned int DefaultWorkers;
+	static std::map<TString, std::vector<TString> > DirectoryCache; // directory -> entries
+	static std::map<TString, CachedMerge> MergeCache;               // name -> merge result
+};
+
+#endif /* HISTOMERGER_H_ */
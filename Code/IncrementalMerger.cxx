@@ -0,0 +1,233 @@
+/*
+ * IncrementalMerger.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "IncrementalMerger.h"
+#include "HistoMerger.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TSystem.h"
+#include "TMD5.h"
+#include <cstring>
+#include <ctime>
+
+IncrementalMerger::IncrementalMerger(TString state_, TString pattern_):
+	state(state_),
+	pattern(pattern_),
+	settleTime(60)
+{
+}
+
+IncrementalMerger::~IncrementalMerger() {
+}
+
+bool IncrementalMerger::Load(){
+	ledger.clear();
+	if(gSystem->AccessPathName(state)) return false; // no state yet
+	TFile f(state, "READ");
+	TTree *t = (TTree*) f.Get("MergeLedger");
+	if(f.IsZombie() || t == NULL){
+		Logger(Logger::Error) << state << " has no MergeLedger. Starting from an empty state." << std::endl;
+		return false;
+	}
+	Char_t job[1024], file[1024], md5[64];
+	Long64_t size, mtime;
+	t->SetBranchAddress("job", job);
+	t->SetBranchAddress("file", file);
+	t->SetBranchAddress("md5", md5);
+	t->SetBranchAddress("size", &size);
+	t->SetBranchAddress("mtime", &mtime);
+	for(Long64_t i=0; i<t->GetEntries(); i++){
+		t->GetEntry(i);
+		Entry e;
+		e.file = file;
+		e.size = size;
+		e.mtime = mtime;
+		e.md5 = md5;
+		ledger[job] = e;
+	}
+	f.Close();
+	Logger(Logger::Info) << "Loaded " << state << " with " << ledger.size() << " merged jobs" << std::endl;
+	return true;
+}
+
+bool IncrementalMerger::Stat(TString file, Long64_t& size, Long64_t& mtime){
+	FileStat_t st;
+	if(gSystem->GetPathInfo(file, st) != 0) return false;
+	size = st.fSize;
+	mtime = st.fMtime;
+	return true;
+}
+
+// job -> output file; a job is a sub directory containing a file matching pattern,
+// or a matching file directly in directory
+void IncrementalMerger::FindOutputs(TString directory, std::map<TString, TString>& outputs){
+	void *dir = gSystem->OpenDirectory(directory);
+	if(dir == NULL){
+		Logger(Logger::Error) << "Could not open directory " << directory << std::endl;
+		return;
+	}
+	// the state and its temporary files may live in the watched directory
+	TString stateName = gSystem->BaseName(state);
+	stateName.ReplaceAll(".root", "");
+	const char *entry;
+	while((entry = gSystem->GetDirEntry(dir))){
+		TString name = entry;
+		if(name == "." || name == ".." || name.BeginsWith(stateName)) continue;
+		TString path = directory + "/" + name;
+		FileStat_t st;
+		if(gSystem->GetPathInfo(path, st) != 0) continue;
+		if(R_ISDIR(st.fMode)){
+			void *sub = gSystem->OpenDirectory(path);
+			if(sub == NULL) continue;
+			const char *subEntry;
+			while((subEntry = gSystem->GetDirEntry(sub))){
+				TString subName = subEntry;
+				if(subName.Contains(pattern) && subName.EndsWith(".root")){
+					outputs[name] = path + "/" + subName;
+					break;
+				}
+			}
+			gSystem->FreeDirectory(sub);
+		}
+		else if(name.Contains(pattern) && name.EndsWith(".root")){
+			outputs[name] = path;
+		}
+	}
+	gSystem->FreeDirectory(dir);
+}
+
+int IncrementalMerger::Update(TString directory){
+	std::map<TString, TString> outputs;
+	FindOutputs(directory, outputs);
+
+	std::map<TString, Entry> newLedger = ledger;
+	std::vector<TString> added;
+	bool rebuild = false;
+	Long64_t now = time(NULL);
+	for(std::map<TString, TString>::const_iterator o = outputs.begin(); o != outputs.end(); o++){
+		Entry e;
+		e.file = o->second;
+		if(!Stat(e.file, e.size, e.mtime)) continue;
+		if(now - e.mtime < (Long64_t) settleTime) continue; // may still be written
+		std::map<TString, Entry>::const_iterator old = ledger.find(o->first);
+		if(old != ledger.end() && old->second.file == e.file && old->second.size == e.size && old->second.mtime == e.mtime) continue;
+		TMD5 *md5 = TMD5::FileChecksum(e.file);
+		if(md5 == NULL) continue;
+		e.md5 = md5->AsString();
+		delete md5;
+		newLedger[o->first] = e;
+		if(old != ledger.end()){
+			if(old->second.md5 == e.md5) continue; // only touched or moved
+			Logger(Logger::Info) << "Output of job " << o->first << " was replaced: " << e.file << std::endl;
+			rebuild = true;
+		}
+		added.push_back(o->first);
+	}
+	if(added.empty()){
+		ledger = newLedger;
+		return 0;
+	}
+
+	if(!ledger.empty() && gSystem->AccessPathName(state)){
+		Logger(Logger::Warning) << state << " disappeared, rebuilding it from the ledger." << std::endl;
+		rebuild = true;
+	}
+	std::vector<TString> files;
+	if(rebuild){
+		// replaced outputs cannot be subtracted: combine the current output of every job again
+		for(std::map<TString, Entry>::const_iterator l = newLedger.begin(); l != newLedger.end(); l++) files.push_back(l->second.file);
+	}
+	else{
+		if(!ledger.empty()) files.push_back(state);
+		for(unsigned int i=0; i<added.size(); i++) files.push_back(newLedger[added.at(i)].file);
+	}
+	if(!Commit(files, newLedger)) return -1;
+	int nAdded = 0;
+	for(unsigned int i=0; i<added.size(); i++){
+		if(ledger.find(added.at(i)) != ledger.end()) nAdded++;
+	}
+	Logger(Logger::Info) << "Merged " << nAdded << " new outputs into " << state << " (" << ledger.size() << " jobs" << (rebuild ? ", rebuilt" : "") << ")" << std::endl;
+	return nAdded;
+}
+
+// merge files into a temporary state, drop unreadable outputs from the ledger and replace the state
+bool IncrementalMerger::Commit(const std::vector<TString>& files, const std::map<TString, Entry>& newLedger){
+	TString tmp = state;
+	tmp.ReplaceAll(".root", "");
+	tmp += ".tmp.root";
+	HistoMerger merger;
+	if(!merger.Merge(files, tmp)){
+		gSystem->Unlink(tmp);
+		return false;
+	}
+	std::map<TString, Entry> l = newLedger;
+	const std::vector<TString>& bad = merger.GetBadFiles();
+	for(unsigned int i=0; i<bad.size(); i++){
+		if(bad.at(i) == state){
+			Logger(Logger::Error) << "Could not read current state " << state << ". Nothing merged." << std::endl;
+			gSystem->Unlink(tmp);
+			return false;
+		}
+		for(std::map<TString, Entry>::iterator it = l.begin(); it != l.end(); it++){
+			if(it->second.file == bad.at(i)){
+				Logger(Logger::Warning) << "Output of job " << it->first << " not readable, will be retried." << std::endl;
+				l.erase(it);
+				break;
+			}
+		}
+	}
+	if(!WriteLedger(tmp, l) || gSystem->Rename(tmp, state) != 0){
+		Logger(Logger::Error) << "Could not replace " << state << std::endl;
+		gSystem->Unlink(tmp);
+		return false;
+	}
+	ledger = l;
+	return true;
+}
+
+bool IncrementalMerger::WriteLedger(TString file, const std::map<TString, Entry>& l){
+	TFile f(file, "UPDATE");
+	if(f.IsZombie()) return false;
+	Char_t job[1024], out[1024], md5[64];
+	Long64_t size, mtime;
+	TTree t("MergeLedger", "merged job outputs");
+	t.Branch("job", job, "job/C");
+	t.Branch("file", out, "file/C");
+	t.Branch("md5", md5, "md5/C");
+	t.Branch("size", &size, "size/L");
+	t.Branch("mtime", &mtime, "mtime/L");
+	for(std::map<TString, Entry>::const_iterator it = l.begin(); it != l.end(); it++){
+		strncpy(job, it->first.Data(), sizeof(job) - 1);
+		job[sizeof(job) - 1] = '\0';
+		strncpy(out, it->second.file.Data(), sizeof(out) - 1);
+		out[sizeof(out) - 1] = '\0';
+		strncpy(md5, it->second.md5.Data(), sizeof(md5) - 1);
+		md5[sizeof(md5) - 1] = '\0';
+		size = it->second.size;
+		mtime = it->second.mtime;
+		t.Fill();
+	}
+	t.Write();
+	f.Close();
+	return true;
+}
+
+void IncrementalMerger::Watch(TString directory, unsigned int interval, unsigned int maxCycles){
+	Logger(Logger::Info) << "Watching " << directory << " for " << pattern << ", stop with: touch " << state << ".stop" << std::endl;
+	for(unsigned int cycle = 1; ; cycle++){
+		if(!gSystem->AccessPathName(state + ".stop")) break;
+		if(Update(directory) < 0)
+			Logger(Logger::Error) << "Update of " << state << " failed, retrying in the next cycle." << std::endl;
+		if(maxCycles > 0 && cycle >= maxCycles) break;
+		gSystem->Sleep(interval * 1000);
+	}
+}
+
+bool IncrementalMerger::Snapshot(TString output){
+	// the state is only replaced by rename, so a copy is always consistent
+	return gSystem->CopyFile(state, output, kTRUE) == 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * IncrementalMerger.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Folds job outputs into a persistent combination as they arrive.
+ *
+ *      The state is one ROOT file with the merged histograms and a ledger
+ *      (TTree "MergeLedger") of the merged job outputs: job, file, size,
+ *      modification time and MD5 checksum. Each Update() lists the watched
+ *      directory, and only outputs which are new are merged into the state
+ *      (see HistoMerger). A job is either a sub directory (e.g. Set_12/)
+ *      or a file directly in the watched directory.
+ *      If the output of a job already in the ledger changes (re-submitted
+ *      job), the state is rebuilt from the current outputs of all jobs in
+ *      the ledger, so that the old output is never double counted.
+ *      The state file is replaced atomically (write + rename): it always is
+ *      a consistent combination which can be used as input of RECONSTRUCT
+ *      (File: <state>.root) or copied with Snapshot().
+ */
+
+#ifndef INCREMENTALMERGER_H_
+#define INCREMENTALMERGER_H_
+
+#include <vector>
+#include <map>
+#include "TString.h"
+#include "Rtypes.h"
+
+class IncrementalMerger {
+public:
+	// state: file name of the combination, pattern: selects the output file in a job directory
+	IncrementalMerger(TString state, TString pattern = ".root");
+	virtual ~IncrementalMerger();
+
+	// read the ledger of an existing state file, false if there is none
+	bool Load();
+	// merge new and changed outputs found in directory, returns the number of merged outputs (-1 on error)
+	int Update(TString directory);
+	// call Update every interval seconds, stop after maxCycles cycles (0: never) or when
+	// the file <state>.stop appears
+	void Watch(TString directory, unsigned int interval, unsigned int maxCycles = 0);
+	// copy of the current state
+	bool Snapshot(TString output);
+
+	unsigned int GetNJobs() const {return ledger.size();}
+	void SetSettleTime(unsigned int s){settleTime = s;}
+
+private:
+	struct Entry {
+		TString file;
+		Long64_t size;
+		Long64_t mtime;
+		TString md5;
+	};
+
+	void FindOutputs(TString directory, std::map<TString, TString>& outputs);
+	bool Stat(TString file, Long64_t& size, Long64_t& mtime);
+	bool Commit(const std::vector<TString>& files, const std::map<TString, Entry>& newLedger);
+	bool WriteLedger(TString file, const std::map<TString, Entry>& l);
+
+	TString state;
+	TString pattern;
+	unsigned int settleTime; // seconds a file has to be unchanged before it is merged
+	std::map<TString, Entry> ledger; // job -> merged output
+};
+
+#endif /* INCREMENTALMERGER_H_ */
@@ -0,0 +1,153 @@
+/*
+ * KeyedRecordFile.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "KeyedRecordFile.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+KeyedRecordFile::KeyedRecordFile(const char* magic, UInt_t formatVersion, size_t recordSize):
+	formatVersion_(formatVersion),
+	recordSize_(recordSize),
+	map_(NULL),
+	mapSize_(0),
+	header_(NULL),
+	index_(NULL),
+	records_(NULL)
+{
+	memcpy(magic_, magic, sizeof(magic_));
+}
+
+KeyedRecordFile::~KeyedRecordFile() {
+	Close();
+}
+
+void KeyedRecordFile::Close(){
+	if(map_ != NULL) munmap(map_, mapSize_);
+	map_ = NULL;
+	mapSize_ = 0;
+	header_ = NULL;
+	index_ = NULL;
+	records_ = NULL;
+}
+
+ULong64_t KeyedRecordFile::GetNRecords() const {
+	return header_ != NULL ? header_->nRecords : 0;
+}
+
+// splitmix64 finalizer of the combined key
+ULong64_t KeyedRecordFile::Hash(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash){
+	ULong64_t x = ((((ULong64_t) run) << 32) | lumi) ^ (((ULong64_t) event) * 0x9E3779B97F4A7C15ULL) ^ inputHash;
+	x ^= x >> 30;
+	x *= 0xBF58476D1CE4E5B9ULL;
+	x ^= x >> 27;
+	x *= 0x94D049BB133111EBULL;
+	x ^= x >> 31;
+	return x;
+}
+
+bool KeyedRecordFile::SameKey(const Key& a, const Key& b){
+	return a.run == b.run && a.lumi == b.lumi && a.event == b.event && a.inputHash == b.inputHash;
+}
+
+bool KeyedRecordFile::Open(TString file, ULong64_t signature){
+	Close();
+	int fd = open(file.Data(), O_RDONLY);
+	if(fd < 0) return false;
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(Header)){
+		close(fd);
+		return false;
+	}
+	void *m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // the mapping stays valid
+	if(m == MAP_FAILED) return false;
+	map_ = m;
+	mapSize_ = st.st_size;
+
+	const Header *h = (const Header*) map_;
+	if(memcmp(h->magic, magic_, sizeof(magic_)) != 0 || h->formatVersion != formatVersion_ || h->recordSize != recordSize_
+			|| h->signature != signature
+			|| mapSize_ != sizeof(Header) + h->capacity * sizeof(UInt_t) + h->nRecords * recordSize_){
+		Logger(Logger::Warning) << file << " was written with another format or from other input, it is not used." << std::endl;
+		Close();
+		return false;
+	}
+	header_ = h;
+	index_ = (const UInt_t*) ((const char*) map_ + sizeof(Header));
+	records_ = (const char*) (index_ + h->capacity);
+	return true;
+}
+
+Long64_t KeyedRecordFile::Write(TString file, ULong64_t signature, const void* records, ULong64_t nRecords) const {
+	const char *rec = (const char*) records;
+	// load factor <= 1/2
+	ULong64_t capacity = 2;
+	while(capacity < 2 * nRecords) capacity <<= 1;
+	std::vector<UInt_t> index(capacity, 0);
+	Long64_t nDuplicates = 0;
+	for(ULong64_t i=0; i<nRecords; i++){
+		const Key& k = *(const Key*) (rec + i * recordSize_);
+		for(ULong64_t s = Hash(k.run, k.lumi, k.event, k.inputHash) & (capacity - 1); ; s = (s + 1) & (capacity - 1)){
+			if(index.at(s) == 0){
+				index.at(s) = i + 1;
+				break;
+			}
+			if(SameKey(*(const Key*) (rec + (index.at(s) - 1) * recordSize_), k)){
+				index.at(s) = i + 1; // last record is used
+				nDuplicates++;
+				break;
+			}
+		}
+	}
+
+	Header h;
+	memset(&h, 0, sizeof(Header));
+	memcpy(h.magic, magic_, sizeof(magic_));
+	h.formatVersion = formatVersion_;
+	h.recordSize = recordSize_;
+	h.signature = signature;
+	h.nRecords = nRecords;
+	h.capacity = capacity;
+
+	TString tmp = file;
+	tmp += ".tmp";
+	tmp += getpid();
+	FILE *f = fopen(tmp.Data(), "wb");
+	if(f == NULL){
+		Logger(Logger::Error) << "Could not create " << tmp << std::endl;
+		return -1;
+	}
+	bool ok = fwrite(&h, sizeof(Header), 1, f) == 1;
+	ok = ok && fwrite(&index.at(0), sizeof(UInt_t), capacity, f) == capacity;
+	if(nRecords > 0) ok = ok && fwrite(rec, recordSize_, nRecords, f) == nRecords;
+	ok = (fclose(f) == 0) && ok;
+	if(!ok || rename(tmp.Data(), file.Data()) != 0){
+		Logger(Logger::Error) << "Could not write " << file << std::endl;
+		unlink(tmp.Data());
+		return -1;
+	}
+	return nDuplicates;
+}
+
+const char* KeyedRecordFile::Find(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash) const {
+	if(header_ == NULL) return NULL;
+	Key k = {run, lumi, event, 0, inputHash};
+	ULong64_t mask = header_->capacity - 1;
+	ULong64_t s = Hash(run, lumi, event, inputHash) & mask;
+	for(ULong64_t n=0; n<header_->capacity; n++, s = (s + 1) & mask){
+		UInt_t i = index_[s];
+		if(i == 0) return NULL;
+		const char *r = records_ + (i - 1) * recordSize_;
+		if(SameKey(*(const Key*) r, k)) return r;
+	}
+	return NULL;
+}
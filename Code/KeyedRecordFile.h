@@ -0,0 +1,87 @@
+/*
+ * KeyedRecordFile.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Read-only, memory-mapped file of fixed size plain-data records with an
+ *      open-addressing hash index on (run, lumi, event, input hash), shared by
+ *      SVFitCache and ProductStore.
+ *
+ *      Every record starts with a Key. A lookup is a few memory accesses
+ *      without ROOT I/O, and all processes on a node which map the same file
+ *      share its pages. Files are written to a temporary name and renamed,
+ *      i.e. a process never maps a partially written file.
+ *
+ *      File layout: Header | UInt_t index[capacity] | records[nRecords]
+ *      index entries are record number + 1 (0: empty slot).
+ *      The signature identifies the content (e.g. the input files or the
+ *      producer and its version), a file with another signature is not used.
+ *      If a key is written more than once, the last record is used.
+ */
+
+#ifndef KEYEDRECORDFILE_H_
+#define KEYEDRECORDFILE_H_
+
+#include <cstddef>
+#include "Rtypes.h"
+#include "TString.h"
+
+class KeyedRecordFile {
+public:
+	struct Key {
+		UInt_t run;
+		UInt_t lumi;
+		UInt_t event;
+		UInt_t reserved; // free for the record
+		ULong64_t inputHash;
+		bool operator<(const Key& o) const {
+			if(inputHash != o.inputHash) return inputHash < o.inputHash;
+			if(event != o.event) return event < o.event;
+			if(run != o.run) return run < o.run;
+			return lumi < o.lumi;
+		}
+	};
+
+	// magic: 8 characters identifying the type of file
+	KeyedRecordFile(const char* magic, UInt_t formatVersion, size_t recordSize);
+	virtual ~KeyedRecordFile();
+
+	// map file, false if it does not exist or has another format or signature
+	bool Open(TString file, ULong64_t signature);
+	void Close();
+	// write nRecords records (each starting with a Key) to file, returns the number of duplicate keys or -1
+	Long64_t Write(TString file, ULong64_t signature, const void* records, ULong64_t nRecords) const;
+
+	// record with the key, NULL if it is not in the file
+	const char* Find(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash) const;
+	const char* GetRecord(ULong64_t i) const {return records_ + i * recordSize_;}
+
+	bool isOpen() const {return header_ != NULL;}
+	ULong64_t GetNRecords() const;
+	size_t GetRecordSize() const {return recordSize_;}
+
+private:
+	struct Header {
+		char magic[8];
+		UInt_t formatVersion;
+		UInt_t recordSize;
+		ULong64_t signature;
+		ULong64_t nRecords;
+		ULong64_t capacity; // power of 2
+	};
+
+	static ULong64_t Hash(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash);
+	static bool SameKey(const Key& a, const Key& b);
+
+	char magic_[8];
+	UInt_t formatVersion_;
+	size_t recordSize_;
+
+	void *map_;
+	size_t mapSize_;
+	const Header *header_;
+	const UInt_t *index_;
+	const char *records_;
+};
+
+#endif /* KEYEDRECORDFILE_H_ */
@@ -6,6 +6,8 @@
 #include "PDG_Var.h"
 #include "TF1.h"
 #include "Parameters.h"
+#include "FitInputRecorder.h"
+#include "FNVHash.h"
 #include "SimpleFits/FitSoftware/interface/Logger.h"
 
 
@@ -21,8 +23,18 @@
 Ntuple_Controller::Ntuple_Controller(std::vector<TString> RootFiles):
   copyTree(false)
   ,cannotObtainHiggsMass(false)
+  ,higgsMassCache_treeNumber(-1)
+  ,higgsMassCache_value(-999)
   ,ObjEvent(-1)
   ,isInit(false)
+  ,vtxCache_isFilled(false)
+  ,tauDiscMask_isFilled(false)
+  ,tauDiscMask_treeNumber(-1)
+  ,tauDiscMask_reported(0)
+  ,objRNG(1234)
+#ifdef USE_TauSpinner
+  ,tauSpinerStore("TauSpinner", 1, 1)
+#endif
 {
   // TChains the ROOTuple file
   TChain *chain = new TChain("t");
@@ -68,12 +80,94 @@ Ntuple_Controller::Ntuple_Controller(std::vector<TString> RootFiles):
 void Ntuple_Controller::InitEvent(){
 	Muon_corrected_p4.clear();
 	Muon_corrected_p4.resize(NMuons());
-	Muon_isCorrected = false;
+	Muon_isCorrected.assign(NMuons(),false);
+	objRNG.SetEvent(RunNumber(),LuminosityBlock(),EventNumber());
+	vtxCache_isFilled = false;
+	tauDiscMask_isFilled = false;
+	gefCache.clear();
 
 	// after everything is initialized
 	isInit = true;
 }
 
+///////////////////////////////////////////////////////////////////////
+//
+// Function: void FillTauDiscriminatorMasks()
+//
+// Purpose: Pack the boolean tau discriminators of all taus into one
+//          bit mask per tau (bits defined in PFTauDiscriminator).
+//          Branches which are not read (size mismatch) leave their bit unset
+//          and are reported once per input file.
+//
+///////////////////////////////////////////////////////////////////////
+namespace {
+	void packDiscriminator(const std::vector<bool>* disc, unsigned int n, std::vector<ULong64_t>& mask, int bit, ULong64_t& missing){
+		ULong64_t b = ULong64_t(1) << bit;
+		if(disc==NULL || disc->size()!=n){
+			missing |= b;
+			return;
+		}
+		for(unsigned int i=0;i<n;i++){
+			if((*disc)[i]) mask[i] |= b;
+		}
+	}
+}
+
+void Ntuple_Controller::FillTauDiscriminatorMasks(){
+	unsigned int n = NPFTaus();
+	tauDiscMask.assign(n,0);
+	ULong64_t missing = 0;
+	if(n>0){
+		packDiscriminator(Ntp->PFTau_isTightIsolation, n, tauDiscMask, PFTauDisc_isTightIsolation, missing);
+		packDiscriminator(Ntp->PFTau_isMediumIsolation, n, tauDiscMask, PFTauDisc_isMediumIsolation, missing);
+		packDiscriminator(Ntp->PFTau_isLooseIsolation, n, tauDiscMask, PFTauDisc_isLooseIsolation, missing);
+		packDiscriminator(Ntp->PFTau_isTightIsolationDBSumPtCorr, n, tauDiscMask, PFTauDisc_isTightIsolationDBSumPtCorr, missing);
+		packDiscriminator(Ntp->PFTau_isMediumIsolationDBSumPtCorr, n, tauDiscMask, PFTauDisc_isMediumIsolationDBSumPtCorr, missing);
+		packDiscriminator(Ntp->PFTau_isLooseIsolationDBSumPtCorr, n, tauDiscMask, PFTauDisc_isLooseIsolationDBSumPtCorr, missing);
+		packDiscriminator(Ntp->PFTau_isVLooseIsolationDBSumPtCorr, n, tauDiscMask, PFTauDisc_isVLooseIsolationDBSumPtCorr, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstElectronsLoose, n, tauDiscMask, PFTauDisc_isHPSAgainstElectronsLoose, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstElectronsMedium, n, tauDiscMask, PFTauDisc_isHPSAgainstElectronsMedium, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstElectronsTight, n, tauDiscMask, PFTauDisc_isHPSAgainstElectronsTight, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstMuonLoose, n, tauDiscMask, PFTauDisc_isHPSAgainstMuonLoose, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstMuonMedium, n, tauDiscMask, PFTauDisc_isHPSAgainstMuonMedium, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstMuonTight, n, tauDiscMask, PFTauDisc_isHPSAgainstMuonTight, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstMuonLoose2, n, tauDiscMask, PFTauDisc_isHPSAgainstMuonLoose2, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstMuonMedium2, n, tauDiscMask, PFTauDisc_isHPSAgainstMuonMedium2, missing);
+		packDiscriminator(Ntp->PFTau_isHPSAgainstMuonTight2, n, tauDiscMask, PFTauDisc_isHPSAgainstMuonTight2, missing);
+		packDiscriminator(Ntp->PFTau_isHPSByDecayModeFinding, n, tauDiscMask, PFTauDisc_isHPSByDecayModeFinding, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByMVA3LooseElectronRejection, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByMVA3LooseElectronRejection, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByMVA3MediumElectronRejection, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByMVA3MediumElectronRejection, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByMVA3TightElectronRejection, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByMVA3TightElectronRejection, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByMVA3VTightElectronRejection, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByMVA3VTightElectronRejection, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByTightCombinedIsolationDBSumPtCorr3Hits, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByTightCombinedIsolationDBSumPtCorr3Hits, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByMediumCombinedIsolationDBSumPtCorr3Hits, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByMediumCombinedIsolationDBSumPtCorr3Hits, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByLooseCombinedIsolationDBSumPtCorr3Hits, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByLooseCombinedIsolationDBSumPtCorr3Hits, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByLooseIsolationMVA, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByLooseIsolationMVA, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByMediumIsolationMVA, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByMediumIsolationMVA, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByTightIsolationMVA, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByTightIsolationMVA, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByLooseIsolationMVA2, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByLooseIsolationMVA2, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByMediumIsolationMVA2, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByMediumIsolationMVA2, missing);
+		packDiscriminator(Ntp->PFTau_HPSPFTauDiscriminationByTightIsolationMVA2, n, tauDiscMask, PFTauDisc_HPSPFTauDiscriminationByTightIsolationMVA2, missing);
+	}
+	tauDiscMask_isFilled = true;
+
+	// all ID cuts on a missing discriminator fail
+	int treeNumber = Ntp->fChain->GetTreeNumber();
+	if(treeNumber != tauDiscMask_treeNumber){
+		tauDiscMask_treeNumber = treeNumber;
+		tauDiscMask_reported = 0;
+	}
+	missing &= ~tauDiscMask_reported;
+	if(missing != 0){
+		tauDiscMask_reported |= missing;
+		TString bits;
+		for(int bit=0; bit<NPFTauDiscriminators; bit++) if(missing & PFTauDiscMask((PFTauDiscriminator) bit)) bits += TString::Format(" %d", bit);
+		TString file = Ntp->fChain->GetCurrentFile() ? Ntp->fChain->GetCurrentFile()->GetName() : "the input";
+		Logger(Logger::Error) << "Tau discriminators (PFTauDiscriminator bits" << bits << ") are missing or do not match the number of taus in "
+				<< file << ", they are treated as failed." << std::endl;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////
 //
 // Function: Int_t Get_Entries()
@@ -291,13 +385,21 @@ TString Ntuple_Controller::GetInputPublishDataName(){
 int Ntuple_Controller::getSampleHiggsMass(){
 	int mass = -999;
 
+	// dataset and file name do not change within one input file
+	int treeNumber = Ntp->fChain->GetTreeNumber();
+	if (treeNumber == higgsMassCache_treeNumber) return higgsMassCache_value;
+
 	// default method: analyze dataset name
 	mass = readHiggsMassFromString( GetInputNtuplePath() );
-	if (mass >= 0) return mass;
 
 	// first fallback: analyze filename (only working when running on GRID)
-	mass = readHiggsMassFromString( Get_File_Name() );
-	if (mass >= 0) return mass;
+	if (mass < 0) mass = readHiggsMassFromString( Get_File_Name() );
+
+	if (mass >= 0) {
+		higgsMassCache_treeNumber = treeNumber;
+		higgsMassCache_value = mass;
+		return mass;
+	}
 
 	// second fallback: get Higgs mass from MC info
 	Logger(Logger::Warning) << "Not able to obtain Higgs mass neither from dataset nor from file name."
@@ -341,15 +443,66 @@ int Ntuple_Controller::getHiggsSampleMassFromGenInfo(){
 }
 
 TMatrixF Ntuple_Controller::Vtx_Cov(unsigned int i){
+  if(!vtxCache_isFilled) FillVtxCache();
+  return vtxCache_cov.at(i);
+}
+
+///////////////////////////////////////////////////////////////////////
+//
+// Function: void FillVtxCache()
+//
+// Purpose: Unpack the vertex information of the event once: positions,
+//          covariances, good vertex flags, first good vertex and number
+//          of tracks. The four-momentum sums of the tracks are computed
+//          on request per vertex (see Vtx_TracksP4Sum).
+//
+///////////////////////////////////////////////////////////////////////
+void Ntuple_Controller::FillVtxCache(){
+  unsigned int nvtx = NVtx();
+  vtxCache_goodMask.ResetAllBits();
+  vtxCache_firstGood = -1;
+  vtxCache_nGood = 0;
+  vtxCache_pos.resize(nvtx);
+  vtxCache_cov.resize(nvtx);
+  vtxCache_nTracks.resize(nvtx);
+  vtxCache_hasTracksP4Sum.assign(nvtx,false);
+  vtxCache_tracksP4Sum.resize(nvtx);
   unsigned int dim=3;
-  TMatrixF M(dim,dim);
-  for(unsigned int j=0;j<dim;j++){
-    for(unsigned int k=0;k<=j;k++){
-      M[j][k]=Ntp->Vtx_Cov->at(i).at(j).at(k);
-      M[k][j]=Ntp->Vtx_Cov->at(i).at(j).at(k);
+  for(unsigned int i=0;i<nvtx;i++){
+    vtxCache_pos.at(i).SetXYZ(Ntp->Vtx_x->at(i),Ntp->Vtx_y->at(i),Ntp->Vtx_z->at(i));
+    TMatrixF& M = vtxCache_cov.at(i);
+    M.ResizeTo(dim,dim);
+    for(unsigned int j=0;j<dim;j++){
+      for(unsigned int k=0;k<=j;k++){
+        M[j][k]=Ntp->Vtx_Cov->at(i).at(j).at(k);
+        M[k][j]=Ntp->Vtx_Cov->at(i).at(j).at(k);
+      }
     }
+    vtxCache_nTracks.at(i) = Ntp->Vtx_TracksP4->at(i).size();
+    if(evaluateGoodVtx(i)){
+      vtxCache_goodMask.SetBitNumber(i);
+      if(vtxCache_firstGood == -1) vtxCache_firstGood = i; // first vertex (highest sum[pT^2]) to fulfill vertex requirements
+      vtxCache_nGood++;
+    }
+  }
+  vtxCache_isFilled = true;
+}
+
+TLorentzVector Ntuple_Controller::Vtx_TracksP4Sum(unsigned int i){
+  if(!vtxCache_isFilled) FillVtxCache();
+  if(!vtxCache_hasTracksP4Sum.at(i)){
+    const std::vector<std::vector<double> >& tracks = Ntp->Vtx_TracksP4->at(i);
+    double px(0), py(0), pz(0), e(0);
+    for(unsigned int j=0;j<tracks.size();j++){
+      e  += tracks.at(j).at(0);
+      px += tracks.at(j).at(1);
+      py += tracks.at(j).at(2);
+      pz += tracks.at(j).at(3);
+    }
+    vtxCache_tracksP4Sum.at(i).SetPxPyPzE(px,py,pz,e);
+    vtxCache_hasTracksP4Sum.at(i) = true;
   }
-  return M;
+  return vtxCache_tracksP4Sum.at(i);
 }
 
 bool Ntuple_Controller::isVtxGood(unsigned int i){
@@ -359,9 +512,10 @@ bool Ntuple_Controller::isVtxGood(unsigned int i){
   return false;
 }
 
-bool Ntuple_Controller::isGoodVtx(unsigned int i){
-	if(fabs(Vtx(i).z())>=24) return false;
-	if(Vtx(i).Perp()>=2) return false;
+// called from FillVtxCache, uses the unpacked vertex position
+bool Ntuple_Controller::evaluateGoodVtx(unsigned int i){
+	if(fabs(vtxCache_pos.at(i).z())>=24) return false;
+	if(vtxCache_pos.at(i).Perp()>=2) return false;
 	if(Vtx_ndof(i)<=4) return false;
 	if(Vtx_isFake(i)) return false;
 	return true;
@@ -429,23 +583,59 @@ bool Ntuple_Controller::isGoodMuon_nooverlapremoval(unsigned int i){
   return false;
 }
 
-void Ntuple_Controller::CorrectMuonP4(){
-	if(isInit){
-		for(unsigned int i=0;i<NMuons();i++){
-			TLorentzVector mup4 = Muon_p4(i,"");
-			int runopt = 0; // 0: no run-dependece
-			float qter = 1.0; // 1.0: don't care about muon momentum uncertainty
-			if(!isData() && GetStrippedMCID()!=DataMCType::DY_emu_embedded && GetStrippedMCID()!=DataMCType::DY_mutau_embedded){
-				rmcor->momcor_mc(mup4,Muon_Charge(i),runopt,qter);
-			}else{
-				rmcor->momcor_data(mup4,Muon_Charge(i),runopt,qter);
-			}
-			Muon_corrected_p4.at(i) = mup4;
-		}
-		Muon_isCorrected = true;
+/////////////////////////////////////////////////////////////////////
+//
+// Rochester muon momentum corrections
+//
+// Muons are corrected lazily: CorrectMuonP4(i) only corrects muon i, CorrectMuonP4() corrects
+// all muons which are not corrected yet in one batch. The random number for the MC resolution
+// tuning is taken from the per-muon stream of objRNG, so the result for a given muon does not
+// depend on which (or how many) other muons have been corrected before.
+//
+
+bool Ntuple_Controller::Muon_useMCCorrection(){
+	return !isData() && GetStrippedMCID()!=DataMCType::DY_emu_embedded && GetStrippedMCID()!=DataMCType::DY_mutau_embedded;
+}
+
+void Ntuple_Controller::CorrectMuonP4(unsigned i){
+	if(!isInit || Muon_isCorrected.at(i)) return;
+	TLorentzVector mup4 = Muon_p4(i,"");
+	int runopt = 0; // 0: no run-dependece
+	float qter = 1.0; // 1.0: don't care about muon momentum uncertainty
+	if(Muon_useMCCorrection()){
+		rmcor->momcor_mc(mup4,Muon_Charge(i),runopt,qter,objRNG.Normal(CounterRNG::Muon,i,CounterRNG::Nominal));
 	}else{
-		Muon_isCorrected = false;
+		rmcor->momcor_data(mup4,Muon_Charge(i),runopt,qter);
+	}
+	Muon_corrected_p4.at(i) = mup4;
+	Muon_isCorrected.at(i) = true;
+}
+
+void Ntuple_Controller::CorrectMuonP4(){
+	if(!isInit){
 		Logger(Logger::Warning) << "No muon corrections applied" << std::endl;
+		return;
+	}
+	// collect uncorrected muons into structure of arrays
+	std::vector<unsigned> idx;
+	std::vector<float> px, py, pz, e, charge;
+	std::vector<double> gaus;
+	bool isMC = Muon_useMCCorrection();
+	for(unsigned int i=0;i<NMuons();i++){
+		if(Muon_isCorrected.at(i)) continue;
+		idx.push_back(i);
+		px.push_back(Ntp->Muon_p4->at(i).at(1));
+		py.push_back(Ntp->Muon_p4->at(i).at(2));
+		pz.push_back(Ntp->Muon_p4->at(i).at(3));
+		e.push_back(Ntp->Muon_p4->at(i).at(0));
+		charge.push_back(Muon_Charge(i));
+		gaus.push_back(isMC ? objRNG.Normal(CounterRNG::Muon,i,CounterRNG::Nominal) : 0.);
+	}
+	if(idx.size()==0) return;
+	rmcor->momcor_batch(isMC,idx.size(),&px.at(0),&py.at(0),&pz.at(0),&e.at(0),&charge.at(0),&gaus.at(0),NULL);
+	for(unsigned int k=0;k<idx.size();k++){
+		Muon_corrected_p4.at(idx.at(k)).SetPxPyPzE(px.at(k),py.at(k),pz.at(k),e.at(k));
+		Muon_isCorrected.at(idx.at(k)) = true;
 	}
 }
 
@@ -460,16 +650,15 @@ void Ntuple_Controller::CorrectMuonP4(){
 //  - "scale": if you don't use momentum corrections, use this to estimate the systematics on the scale (only MC).
 //             Add "down" in order to estimate it for downward variations.
 //  - "res": if you don't use momentum corrections, use this to estimate systematics caused by momentum resolution (only MC)
+//           The smearing is deterministic per muon and event (see CounterRNG), i.e. repeated calls give the same result.
 //
 
 TLorentzVector Ntuple_Controller::Muon_p4(unsigned int i, TString corr){
 	TLorentzVector vec = TLorentzVector(Ntp->Muon_p4->at(i).at(1),Ntp->Muon_p4->at(i).at(2),Ntp->Muon_p4->at(i).at(3),Ntp->Muon_p4->at(i).at(0));
 	if (corr == "default") corr = muonCorrection;
 	if(corr.Contains("roch")){
-		if(!Muon_isCorrected){
-			CorrectMuonP4();
-		}
-		if(Muon_isCorrected){
+		CorrectMuonP4(i);
+		if(Muon_isCorrected.at(i)){
 			vec = Muon_corrected_p4.at(i);
 		}
 		else{
@@ -481,7 +670,7 @@ TLorentzVector Ntuple_Controller::Muon_p4(unsigned int i, TString corr){
 			if(!corr.Contains("down")) vec.SetPerp(vec.Perp()*1.002);
 			else vec.SetPerp(vec.Perp()*0.998);
 		}else if(corr.Contains("res")){
-			vec.SetPerp(gRandom->Gaus(vec.Perp(),vec.Perp()*0.006));
+			vec.SetPerp(objRNG.Gaus(vec.Perp(),vec.Perp()*0.006,CounterRNG::Muon,i,CounterRNG::Resolution));
 		}
 		if(corr.Contains("met")){
 			if(!corr.Contains("down")) vec.SetPerp(vec.Perp() * 1.002);
@@ -546,6 +735,7 @@ bool Ntuple_Controller::isSelectedMuon(unsigned int i, unsigned int j, double im
 //           resolution in barrel (endcaps) for 2012: 1.6% (4.1%). uncertainty on resolution: 10%
 //           RegEnergy corresponds to the electron energy after regression but before scale correction (data)
 //           or smearing (MC)
+//           The smearing is deterministic per electron and event (see CounterRNG).
 //
 
 TLorentzVector Ntuple_Controller::Electron_p4(unsigned int i, TString corr){
@@ -559,12 +749,12 @@ TLorentzVector Ntuple_Controller::Electron_p4(unsigned int i, TString corr){
 		if(corr.Contains("res")){
 			if(Electron_RegEnergy(i)>0){
 				if(fabs(Electron_supercluster_eta(i))<1.479){
-					if(corr.Contains("down")) vec.SetPerp(vec.Perp() * gRandom->Gaus(Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0144) / Electron_RegEnergy(i));
-					else vec.SetPerp(gRandom->Gaus(vec.Perp() * Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0176) / Electron_RegEnergy(i));
+					if(corr.Contains("down")) vec.SetPerp(vec.Perp() * objRNG.Gaus(Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0144,CounterRNG::Electron,i,CounterRNG::ResolutionDown) / Electron_RegEnergy(i));
+					else vec.SetPerp(objRNG.Gaus(vec.Perp() * Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0176,CounterRNG::Electron,i,CounterRNG::Resolution) / Electron_RegEnergy(i));
 				}
 				else if(fabs(Electron_supercluster_eta(i))<2.5){
-					if(corr.Contains("down")) vec.SetPerp(vec.Perp() * gRandom->Gaus(Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0369) / Electron_RegEnergy(i));
-					else vec.SetPerp(gRandom->Gaus(vec.Perp() * Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0451) / Electron_RegEnergy(i));
+					if(corr.Contains("down")) vec.SetPerp(vec.Perp() * objRNG.Gaus(Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0369,CounterRNG::Electron,i,CounterRNG::ResolutionDown) / Electron_RegEnergy(i));
+					else vec.SetPerp(objRNG.Gaus(vec.Perp() * Electron_RegEnergy(i),Electron_RegEnergy(i)*0.0451,CounterRNG::Electron,i,CounterRNG::Resolution) / Electron_RegEnergy(i));
 				}
 				else{
 					Logger(Logger::Warning) << "Eta out of range: " << Electron_supercluster_eta(i) << ". Returning fourvector w/o smearing for resolution uncertainties." << std::endl;
@@ -955,6 +1145,17 @@ TLorentzVector Ntuple_Controller::PFJet_p4(unsigned int i, TString corr){
 	return vec;
 }
 
+#ifdef USE_TauSpinner
+namespace {
+ULong64_t hashSimpleParticle(ULong64_t h, const SimpleParticle& p){
+  double v[4] = {p.px(), p.py(), p.pz(), p.e()};
+  int pdgid = p.pdgid();
+  h = FNVHash::Add(h, v, sizeof(v));
+  return FNVHash::Add(h, &pdgid, sizeof(pdgid));
+}
+}
+#endif
+
 double Ntuple_Controller::TauSpinerGet(int SpinType){
 #ifdef USE_TauSpinner
   if(!isData()){
@@ -1016,7 +1217,23 @@ double Ntuple_Controller::TauSpinerGet(int SpinType){
 	  }
 	  if(tau1good && tau2good){
 		Logger(Logger::Verbose)  << "Two Taus found: " << tau_daughters.size() << " " << tau_daughters2.size() << std::endl;
-	    return TauSpinerInt.Get(SpinType,X,tau,tau_daughters,tau2,tau_daughters2);
+	    // the weight depends only on the generated particles, it is computed once per campaign
+	    ULong64_t inputHash = FNVHash::Start;
+	    int signalcharge = TauSpinerInt.GetTauSignalCharge();
+	    inputHash = FNVHash::Add(inputHash, &SpinType, sizeof(SpinType));
+	    inputHash = FNVHash::Add(inputHash, &signalcharge, sizeof(signalcharge));
+	    inputHash = hashSimpleParticle(inputHash, X);
+	    inputHash = hashSimpleParticle(inputHash, tau);
+	    inputHash = hashSimpleParticle(inputHash, tau2);
+	    for(unsigned int d=0; d<tau_daughters.size(); d++) inputHash = hashSimpleParticle(inputHash, tau_daughters.at(d));
+	    inputHash = FNVHash::Add(inputHash, "|", 1); // separates the two lists of daughters
+	    for(unsigned int d=0; d<tau_daughters2.size(); d++) inputHash = hashSimpleParticle(inputHash, tau_daughters2.at(d));
+	    double weight;
+	    if(!tauSpinerStore.Get(RunNumber(), LuminosityBlock(), EventNumber(), inputHash, &weight)){
+	      weight = TauSpinerInt.Get(SpinType,X,tau,tau_daughters,tau2,tau_daughters2);
+	      tauSpinerStore.Put(RunNumber(), LuminosityBlock(), EventNumber(), inputHash, &weight);
+	    }
+	    return weight;
 	  }
 	}
       }
@@ -1599,18 +1816,22 @@ std::vector<int> Ntuple_Controller::sortDefaultObjectsByPt(TString objectType){
 SVFitObject* Ntuple_Controller::getSVFitResult_MuTauh(SVFitStorage& svFitStor, TString metType, unsigned muIdx, unsigned tauIdx, unsigned rerunEvery /* = 5000 */, TString suffix /* ="" */, double scaleMu /* =1 */, double scaleTau /* =1 */) {
 	 // configure svfitstorage on first call
 	if ( !svFitStor.isConfigured() ) svFitStor.Configure(GetInputDatasetName(), suffix);
-	// get SVFit result from cache
-	SVFitObject* svfObj = svFitStor.GetEvent(RunNumber(), LuminosityBlock(), EventNumber());
-	// if obtained object is not valid, create and store it
+	// get SVFit result from cache, identified by event and fit inputs
+	objects::MET met(this, metType);
+	SVfitProvider svfProv(this, met, "Mu", muIdx, "Tau", tauIdx, 1, scaleMu, scaleTau);
+	SVFitObject* svfObj = svFitStor.GetEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfProv.get_inputHash());
+	// if obtained object is not valid, create and store it (or list it in request mode, to be fitted by SVfitFit.exe)
 	if (!svfObj->isValid()) {
-		runAndSaveSVFit_MuTauh(svfObj, svFitStor, metType, muIdx, tauIdx, scaleMu, scaleTau);
+		if (SVFitStorage::isRequestMode()) svFitStor.RequestEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfProv.get_inputHash(), svfProv.get_inputs());
+		else runAndSaveSVFit(svfObj, svFitStor, svfProv, PFTau_hpsDecayMode(tauIdx));
 	}
 	else{
 		// calculate every N'th event and compare with what is stored
-		if( (EventNumber() % rerunEvery) == 123){
+		if( !SVFitStorage::isRequestMode() && (EventNumber() % rerunEvery) == 123){
 			SVFitObject* newSvfObj = new SVFitObject();
-			runAndSaveSVFit_MuTauh(newSvfObj, svFitStor, metType, muIdx, tauIdx, scaleMu, scaleTau, false); // will not be saved in output files
+			runAndSaveSVFit(newSvfObj, svFitStor, svfProv, PFTau_hpsDecayMode(tauIdx), false); // will not be saved in output files
 
+			SVfitStatistics::Instance().AddRerun(SVfitStatistics::Instance().GetCategory(), PFTau_hpsDecayMode(tauIdx), newSvfObj->get_fitMethod(), *svfObj == *newSvfObj);
 			if (*svfObj == *newSvfObj){
 				Logger(Logger::Info) << "Recalculation of SVFit object gave same result." << std::endl;
 			}
@@ -1628,39 +1849,110 @@ SVFitObject* Ntuple_Controller::getSVFitResult_MuTauh(SVFitStorage& svFitStor, T
 SVFitObject* Ntuple_Controller::getSVFitResult_MuTau3p(SVFitStorage& svFitStor, TString metType, unsigned muIdx, TLorentzVector tauLV, LorentzVectorParticle neutrino, TString suffix /* ="" */, double scaleMu /* =1 */, double scaleTau /* =1 */) {
 	 // configure svfitstorage on first call
 	if ( !svFitStor.isConfigured() ) svFitStor.Configure(GetInputDatasetName(), suffix);
-	// get SVFit result from cache
-	SVFitObject* svfObj = svFitStor.GetEvent(RunNumber(), LuminosityBlock(), EventNumber());
-	// if obtained object is not valid, create and store it
+	// get SVFit result from cache, identified by event and fit inputs
+	objects::MET met(this, metType);
+	met.subtractNeutrino(neutrino);
+	SVfitProvider svfProv(this, met, "Mu", muIdx, tauLV, 1, scaleMu, scaleTau);
+	SVFitObject* svfObj = svFitStor.GetEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfProv.get_inputHash());
+	// if obtained object is not valid, create and store it (or list it in request mode, to be fitted by SVfitFit.exe)
 	if (!svfObj->isValid()) {
-		runAndSaveSVFit_MuTau3p(svfObj, svFitStor, metType, muIdx, tauLV, neutrino, scaleMu, scaleTau);
+		if (SVFitStorage::isRequestMode()) svFitStor.RequestEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfProv.get_inputHash(), svfProv.get_inputs());
+		else runAndSaveSVFit(svfObj, svFitStor, svfProv, 10); // fully reconstructed 3-prong tau (hps decay mode 10)
 	}
 	return svfObj;
 }
 
-// create SVFitObject from standard muon and standard tau_h
-void Ntuple_Controller::runAndSaveSVFit_MuTauh(SVFitObject* svfObj, SVFitStorage& svFitStor, const TString& metType, unsigned muIdx, unsigned tauIdx, double scaleMu, double scaleTau, bool save /*= true*/) {
+namespace {
+// stores a result of SVfitPool and passes it on
+class SVFitSaver : public SVfitPool::Consumer {
+public:
+	SVFitSaver(SVFitStorage& svFitStor, UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, int decayMode, SVfitPool::Consumer* consumer):
+		svFitStor_(svFitStor), run_(run), lumi_(lumi), event_(event), inputHash_(inputHash),
+		category_(SVfitStatistics::Instance().GetCategory()), decayMode_(decayMode), consumer_(consumer) {}
+	virtual ~SVFitSaver() {delete consumer_;}
+	virtual void FitDone(const SVFitObject& result, const SVfitProvider::FitStats& stats) {
+		SVfitStatistics::Instance().AddFit(category_, decayMode_, result, stats);
+		consumer_->FitDone(result, stats);
+	}
+	virtual void Consume(const SVFitObject& result) {
+		if (result.isValid()) {
+			SVFitObject obj = result;
+			svFitStor_.SaveEvent(run_, lumi_, event_, &obj, inputHash_);
+		} else {
+			Logger(Logger::Error) << "Unable to create a valid SVFit object." << std::endl;
+		}
+		consumer_->Consume(result);
+	}
+private:
+	SVFitStorage& svFitStor_;
+	UInt_t run_, lumi_, event_;
+	ULong64_t inputHash_;
+	TString category_; // at submission
+	int decayMode_;
+	SVfitPool::Consumer* consumer_;
+};
+}
+
+void Ntuple_Controller::getSVFitResult_MuTauh(SVfitPool::Consumer* consumer, SVFitStorage& svFitStor, TString metType, unsigned muIdx, unsigned tauIdx, unsigned rerunEvery /* = 5000 */, TString suffix /* ="" */, double scaleMu /* =1 */, double scaleTau /* =1 */) {
+	SVfitPool& pool = SVfitPool::Instance();
+	if ( !pool.isAsync() || SVFitStorage::isRequestMode() ) {
+		// same as the synchronous access, through the pool to keep the order of the results
+		pool.Deliver(*getSVFitResult_MuTauh(svFitStor, metType, muIdx, tauIdx, rerunEvery, suffix, scaleMu, scaleTau), consumer);
+		return;
+	}
+	if ( !svFitStor.isConfigured() ) svFitStor.Configure(GetInputDatasetName(), suffix);
 	objects::MET met(this, metType);
 	SVfitProvider svfProv(this, met, "Mu", muIdx, "Tau", tauIdx, 1, scaleMu, scaleTau);
-	*svfObj = svfProv.runAndMakeObject();
+	SVFitObject* svfObj = svFitStor.GetEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfProv.get_inputHash());
 	if (svfObj->isValid()) {
-		// store only if object is valid
-		if (save) svFitStor.SaveEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfObj);
-	} else {
-		Logger(Logger::Error) << "Unable to create a valid SVFit object." << std::endl;
+		// compare every N'th event with a recalculation (done synchronously)
+		if ( (EventNumber() % rerunEvery) == 123 ) svfObj = getSVFitResult_MuTauh(svFitStor, metType, muIdx, tauIdx, rerunEvery, suffix, scaleMu, scaleTau);
+		pool.Deliver(*svfObj, consumer);
+		return;
 	}
+	SVfitPool::Key key = {RunNumber(), LuminosityBlock(), EventNumber(), svfProv.get_inputHash()};
+	pool.Submit(svfProv.get_inputs(), key, new SVFitSaver(svFitStor, RunNumber(), LuminosityBlock(), EventNumber(), svfProv.get_inputHash(), PFTau_hpsDecayMode(tauIdx), consumer));
 }
-// create SVFitObject from standard muon and fully reconstructed 3prong tau
-void Ntuple_Controller::runAndSaveSVFit_MuTau3p(SVFitObject* svfObj, SVFitStorage& svFitStor, const TString& metType, unsigned muIdx, TLorentzVector tauLV, LorentzVectorParticle neutrino, double scaleMu, double scaleTau, bool save /*= true*/){
-	objects::MET met(this, metType);
-	met.subtractNeutrino(neutrino);
-	SVfitProvider svfProv(this, met, "Mu", muIdx, tauLV, 1, scaleMu, scaleTau);
+
+// create SVFitObject by running the fit of svfProv, store it if it is valid and save is set
+void Ntuple_Controller::runAndSaveSVFit(SVFitObject* svfObj, SVFitStorage& svFitStor, SVfitProvider& svfProv, int decayMode, bool save /*= true*/) {
 	*svfObj = svfProv.runAndMakeObject();
+	SVfitStatistics::Instance().AddFit(SVfitStatistics::Instance().GetCategory(), decayMode, *svfObj, svfProv.get_fitStats());
 	if (svfObj->isValid()) {
 		// store only if object is valid
-		if (save) svFitStor.SaveEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfObj);
+		if (save) svFitStor.SaveEvent(RunNumber(), LuminosityBlock(), EventNumber(), svfObj, svfProv.get_inputHash());
 	} else {
 		Logger(Logger::Error) << "Unable to create a valid SVFit object." << std::endl;
 	}
 }
 
+
 #endif // USE_SVfit
+
+namespace {
+ULong64_t hashMatrix(ULong64_t h, const TMatrixTBase<double>& m){
+	return FNVHash::Add(h, m.GetMatrixArray(), m.GetNoElements() * sizeof(double));
+}
+}
+
+// The fit only depends on the muon track, the a1, the direction of the recoil and the primary vertex.
+// Categories and systematics which do not change these inputs get the result of the first fit.
+const Ntuple_Controller::GEFResult& Ntuple_Controller::GlobalEventFit_MuTau3p(TrackParticle muon, LorentzVectorParticle a1, double phiRes, TVector3 pv, TMatrixTSym<double> pvCov){
+	ULong64_t inputHash = FNVHash::Start;
+	inputHash = hashMatrix(inputHash, muon.getParMatrix());
+	inputHash = hashMatrix(inputHash, muon.getCovMatrix());
+	inputHash = hashMatrix(inputHash, a1.getParMatrix());
+	inputHash = hashMatrix(inputHash, a1.getCovMatrix());
+	double v[4] = {phiRes, pv.X(), pv.Y(), pv.Z()};
+	inputHash = FNVHash::Add(inputHash, v, sizeof(v));
+	inputHash = hashMatrix(inputHash, pvCov);
+
+	std::map<ULong64_t, GEFResult>::const_iterator it = gefCache.find(inputHash);
+	if (it != gefCache.end()) return it->second;
+	//Logger::Instance()->setLevelForClass("GlobalEventFit", Logger::Debug);
+	FitInputRecorder::Instance().Add(RunNumber(), LuminosityBlock(), EventNumber(), muon, a1, phiRes, pv, pvCov);
+	GlobalEventFit GEF(muon, a1, phiRes, pv, pvCov);
+	TPTRObject tptr = GEF.getTPTRObject();
+	GEFObject fit = GEF.Fit();
+	return gefCache.insert(std::make_pair(inputHash, GEFResult(tptr, fit))).first->second;
+}
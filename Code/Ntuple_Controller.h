@@ -26,11 +26,14 @@
 // Include files (C & C++ libraries)
 #include<iostream>
 #include <vector>
+#include <map>
 #include <string.h>
 
 #include "NtupleReader.h"
 
 #include "HistoConfig.h"
+#include "CounterRNG.h"
+#include "ProductStore.h"
 #ifdef USE_TauSpinner
 #include "TauSpinerInterface.h"
 #endif
@@ -41,6 +44,8 @@
 #include "DataFormats/SVFitObject.h"
 #include "SVFitStorage.h"
 #include "SVfitProvider.h"
+#include "SVfitPool.h"
+#include "SVfitStatistics.h"
 #endif
 
 
@@ -49,6 +54,7 @@
 #include "SimpleFits/FitSoftware/interface/MultiProngTauSolver.h"
 #include "SimpleFits/FitSoftware/interface/ErrorMatrixPropagator.h"
 #include "SimpleFits/FitSoftware/interface/TauA1NuConstrainedFitter.h"
+#include "SimpleFits/FitSoftware/interface/GlobalEventFit.h"
 
 // Rochester muon momentum correction
 #include "CommonFiles/rochcor2012jan22.h"
@@ -88,6 +94,8 @@ class Ntuple_Controller{
   int currentEvent;
 
   bool cannotObtainHiggsMass; // avoid repeated printing of warning when running locally
+  int  higgsMassCache_treeNumber; // Higgs mass from dataset/file name is cached per input file
+  int  higgsMassCache_value;
 
   // Ntuple Access Functions
   virtual void Branch_Setup(TString B_Name, int type);
@@ -133,6 +141,7 @@ class Ntuple_Controller{
   // Interfaces
 #ifdef USE_TauSpinner  
   TauSpinerInterface TauSpinerInt;
+  ProductStore tauSpinerStore; // weights of all jobs of the campaign, see ProductStore
 #endif
   HistoConfig HistoC;
 
@@ -147,15 +156,41 @@ class Ntuple_Controller{
   // muon correction related objects
   rochcor2012*   rmcor;
   std::vector<TLorentzVector> Muon_corrected_p4;
-  void           CorrectMuonP4();
-  bool           Muon_isCorrected;
+  std::vector<bool> Muon_isCorrected;
+  void           CorrectMuonP4();           // all muons of the event in one batch
+  void           CorrectMuonP4(unsigned i); // single muon, only if not yet corrected
+  bool           Muon_useMCCorrection();
+
+  // per-event vertex summary, filled on first access (see FillVtxCache)
+  bool                        vtxCache_isFilled;
+  TBits                       vtxCache_goodMask;
+  int                         vtxCache_firstGood;
+  unsigned int                vtxCache_nGood;
+  std::vector<TVector3>       vtxCache_pos;
+  std::vector<TMatrixF>       vtxCache_cov;
+  std::vector<unsigned int>   vtxCache_nTracks;
+  std::vector<bool>           vtxCache_hasTracksP4Sum;
+  std::vector<TLorentzVector> vtxCache_tracksP4Sum;
+  void                        FillVtxCache();
+  bool                        evaluateGoodVtx(unsigned int i);
+
+  // tau discriminators packed into one bit mask per tau, filled on first access
+  bool                        tauDiscMask_isFilled;
+  std::vector<ULong64_t>      tauDiscMask;
+  int                         tauDiscMask_treeNumber;
+  ULong64_t                   tauDiscMask_reported; // missing discriminators already reported for this file
+  void                        FillTauDiscriminatorMasks();
+
+  // deterministic per-object random numbers for smearing (keyed by run/lumi/event)
+  CounterRNG     objRNG;
+
+  // results of GlobalEventFit_MuTau3p in this event, keyed on a hash of the fit inputs
+  std::map<ULong64_t, GEFResult> gefCache;
 
   // helpers for SVFit
 #ifdef USE_SVfit
-  // create SVFitObject from standard muon and standard tau_h
-  void runAndSaveSVFit_MuTauh(SVFitObject* svfObj, SVFitStorage& svFitStor, const TString& metType, unsigned muIdx, unsigned tauIdx, double scaleMu, double scaleTau, bool save = true);
-  // create SVFitObject from standard muon and fully reconstructed 3prong tau
-  void runAndSaveSVFit_MuTau3p(SVFitObject* svfObj, SVFitStorage& svFitStor, const TString& metType, unsigned muIdx, TLorentzVector tauLV, LorentzVectorParticle neutrino, double scaleMu, double scaleTau, bool save = true);
+  // create SVFitObject by running the fit of svfProv (decayMode: hps decay mode of the tau, 10 for a fully reconstructed 3prong tau)
+  void runAndSaveSVFit(SVFitObject* svfObj, SVFitStorage& svFitStor, SVfitProvider& svfProv, int decayMode, bool save = true);
 #endif
 
  public:
@@ -187,8 +222,16 @@ TauSpinerInt.SetTauSignalCharge(signalcharge);
   #ifdef USE_SVfit
   SVFitObject* getSVFitResult_MuTauh(SVFitStorage& svFitStor, TString metType, unsigned muIdx, unsigned tauIdx, unsigned rerunEvery = 5000, TString suffix = "", double scaleMu = 1 , double scaleTau = 1);
   SVFitObject* getSVFitResult_MuTau3p(SVFitStorage& svFitStor, TString metType, unsigned muIdx, TLorentzVector tauLV, LorentzVectorParticle neutrino, TString suffix = "", double scaleMu = 1, double scaleTau = 1);
+  // as above, but the result is passed to consumer (which is deleted afterwards): immediately if it is stored,
+  // otherwise when the fit is done in SVfitPool. New results are stored in svFitStor.
+  void getSVFitResult_MuTauh(SVfitPool::Consumer* consumer, SVFitStorage& svFitStor, TString metType, unsigned muIdx, unsigned tauIdx, unsigned rerunEvery = 5000, TString suffix = "", double scaleMu = 1 , double scaleTau = 1);
   #endif
 
+  // global event fit of muon and 3-prong tau: run once per event for each distinct set of inputs,
+  // the result is shared by all categories and systematic variations (see gefCache)
+  typedef std::pair<TPTRObject, GEFObject> GEFResult;
+  const GEFResult& GlobalEventFit_MuTau3p(TrackParticle muon, LorentzVectorParticle a1, double phiRes, TVector3 pv, TMatrixTSym<double> pvCov);
+
 
   // Ntuple Access Functions 
   virtual Int_t Get_Entries();
@@ -214,7 +257,8 @@ TauSpinerInt.SetTauSignalCharge(signalcharge);
 
   // Set object corrections to be applied
   void SetTauCorrections(TString tauCorr){tauCorrection = tauCorr;}
-  void SetMuonCorrections(TString muonCorr){muonCorrection = muonCorr;}
+  // with Rochester corrections all muons of the event are corrected at once (selections are setting them per event)
+  void SetMuonCorrections(TString muonCorr){muonCorrection = muonCorr; if(isInit && muonCorrection.Contains("roch")) CorrectMuonP4();}
   void SetElecCorrections(TString elecCorr){elecCorrection = elecCorr;}
   void SetJetCorrections(TString jetCorr){jetCorrection = jetCorr;}
   // corresponding getters
@@ -285,7 +329,7 @@ TauSpinerInt.SetTauSignalCharge(signalcharge);
 
   // Vertex Information
   unsigned int NVtx(){return Ntp->Vtx_ndof->size();}
-  TVector3     Vtx(unsigned int i){return TVector3(Ntp->Vtx_x->at(i),Ntp->Vtx_y->at(i),Ntp->Vtx_z->at(i));}
+  TVector3     Vtx(unsigned int i){if(!vtxCache_isFilled) FillVtxCache(); return vtxCache_pos.at(i);}
   double       Vtx_chi2(unsigned int i){return Ntp->Vtx_chi2->at(i);}
   unsigned     Vtx_nTrk(unsigned int i){return Ntp->Vtx_nTrk->at(i);}
   float        Vtx_ndof(unsigned int i){return Ntp->Vtx_ndof->at(i);}
@@ -295,7 +339,14 @@ TauSpinerInt.SetTauSignalCharge(signalcharge);
   TLorentzVector Vtx_TracksP4(unsigned int i, unsigned int j){return TLorentzVector(Ntp->Vtx_TracksP4->at(i).at(j).at(1),Ntp->Vtx_TracksP4->at(i).at(j).at(2),Ntp->Vtx_TracksP4->at(i).at(j).at(3),Ntp->Vtx_TracksP4->at(i).at(j).at(0));}
 
   bool isVtxGood(unsigned int i);
-  bool isGoodVtx(unsigned int i);
+  bool isGoodVtx(unsigned int i){if(!vtxCache_isFilled) FillVtxCache(); return vtxCache_goodMask.TestBitNumber(i);}
+
+  // per-event vertex summary (computed once per event)
+  const TBits&   GoodVtxMask(){if(!vtxCache_isFilled) FillVtxCache(); return vtxCache_goodMask;}
+  unsigned int   NGoodVtx(){if(!vtxCache_isFilled) FillVtxCache(); return vtxCache_nGood;}
+  int            FirstGoodVtx(){if(!vtxCache_isFilled) FillVtxCache(); return vtxCache_firstGood;} // -1 if no good vertex
+  unsigned int   Vtx_NTracksP4(unsigned int i){if(!vtxCache_isFilled) FillVtxCache(); return vtxCache_nTracks.at(i);}
+  TLorentzVector Vtx_TracksP4Sum(unsigned int i);
 
   // Muon information
   unsigned int   NMuons(){return Ntp->Muon_p4->size();}
@@ -383,37 +434,76 @@ TauSpinerInt.SetTauSignalCharge(signalcharge);
    unsigned int      NPFTaus(){return Ntp->PFTau_p4->size();}
    TLorentzVector	 PFTau_p4(unsigned int i, TString corr = "default");
    TVector3          PFTau_Poca(unsigned int i){return TVector3(Ntp->PFTau_Poca->at(i).at(0),Ntp->PFTau_Poca->at(i).at(1),Ntp->PFTau_Poca->at(i).at(2));}
-   bool PFTau_isTightIsolation(unsigned int i){return Ntp->PFTau_isTightIsolation->at(i);}
-   bool PFTau_isMediumIsolation(unsigned int i){return  Ntp->PFTau_isMediumIsolation->at(i);}
-   bool PFTau_isLooseIsolation(unsigned int i){return  Ntp->PFTau_isLooseIsolation->at(i);}
-   bool PFTau_isTightIsolationDBSumPtCorr(unsigned int i){return  Ntp->PFTau_isTightIsolationDBSumPtCorr->at(i);}
-   bool PFTau_isMediumIsolationDBSumPtCorr(unsigned int i){return  Ntp->PFTau_isMediumIsolationDBSumPtCorr->at(i);}
-   bool PFTau_isLooseIsolationDBSumPtCorr(unsigned int i){return  Ntp->PFTau_isLooseIsolationDBSumPtCorr->at(i);}
-   bool PFTau_isVLooseIsolationDBSumPtCorr(unsigned int i){return  Ntp->PFTau_isVLooseIsolationDBSumPtCorr->at(i);}
-   bool PFTau_isHPSAgainstElectronsLoose(unsigned int i){return  Ntp->PFTau_isHPSAgainstElectronsLoose->at(i);}
-   bool PFTau_isHPSAgainstElectronsMedium(unsigned int i){return  Ntp->PFTau_isHPSAgainstElectronsMedium->at(i);}
-   bool PFTau_isHPSAgainstElectronsTight(unsigned int i){return  Ntp->PFTau_isHPSAgainstElectronsTight->at(i);}
-   bool PFTau_isHPSAgainstMuonLoose(unsigned int i){return  Ntp->PFTau_isHPSAgainstMuonLoose->at(i);}
-   bool PFTau_isHPSAgainstMuonMedium(unsigned int i){return  Ntp->PFTau_isHPSAgainstMuonMedium->at(i);}
-   bool PFTau_isHPSAgainstMuonTight(unsigned int i){return  Ntp->PFTau_isHPSAgainstMuonTight->at(i);}
-   bool PFTau_isHPSAgainstMuonLoose2(unsigned int i){return  Ntp->PFTau_isHPSAgainstMuonLoose2->at(i);}
-   bool PFTau_isHPSAgainstMuonMedium2(unsigned int i){return  Ntp->PFTau_isHPSAgainstMuonMedium2->at(i);}
-   bool PFTau_isHPSAgainstMuonTight2(unsigned int i){return  Ntp->PFTau_isHPSAgainstMuonTight2->at(i);}
-   bool PFTau_isHPSByDecayModeFinding(unsigned int i){return  Ntp->PFTau_isHPSByDecayModeFinding->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByMVA3LooseElectronRejection(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByMVA3LooseElectronRejection->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByMVA3MediumElectronRejection(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByMVA3MediumElectronRejection->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByMVA3TightElectronRejection(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByMVA3TightElectronRejection->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByMVA3VTightElectronRejection(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByMVA3VTightElectronRejection->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByTightCombinedIsolationDBSumPtCorr3Hits(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByTightCombinedIsolationDBSumPtCorr3Hits->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByMediumCombinedIsolationDBSumPtCorr3Hits(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByMediumCombinedIsolationDBSumPtCorr3Hits->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByLooseCombinedIsolationDBSumPtCorr3Hits(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByLooseCombinedIsolationDBSumPtCorr3Hits->at(i);}
+   // bits of the packed tau discriminator mask (see PFTau_discriminatorMask)
+   enum PFTauDiscriminator {
+     PFTauDisc_isTightIsolation = 0,
+     PFTauDisc_isMediumIsolation,
+     PFTauDisc_isLooseIsolation,
+     PFTauDisc_isTightIsolationDBSumPtCorr,
+     PFTauDisc_isMediumIsolationDBSumPtCorr,
+     PFTauDisc_isLooseIsolationDBSumPtCorr,
+     PFTauDisc_isVLooseIsolationDBSumPtCorr,
+     PFTauDisc_isHPSAgainstElectronsLoose,
+     PFTauDisc_isHPSAgainstElectronsMedium,
+     PFTauDisc_isHPSAgainstElectronsTight,
+     PFTauDisc_isHPSAgainstMuonLoose,
+     PFTauDisc_isHPSAgainstMuonMedium,
+     PFTauDisc_isHPSAgainstMuonTight,
+     PFTauDisc_isHPSAgainstMuonLoose2,
+     PFTauDisc_isHPSAgainstMuonMedium2,
+     PFTauDisc_isHPSAgainstMuonTight2,
+     PFTauDisc_isHPSByDecayModeFinding,
+     PFTauDisc_HPSPFTauDiscriminationByMVA3LooseElectronRejection,
+     PFTauDisc_HPSPFTauDiscriminationByMVA3MediumElectronRejection,
+     PFTauDisc_HPSPFTauDiscriminationByMVA3TightElectronRejection,
+     PFTauDisc_HPSPFTauDiscriminationByMVA3VTightElectronRejection,
+     PFTauDisc_HPSPFTauDiscriminationByTightCombinedIsolationDBSumPtCorr3Hits,
+     PFTauDisc_HPSPFTauDiscriminationByMediumCombinedIsolationDBSumPtCorr3Hits,
+     PFTauDisc_HPSPFTauDiscriminationByLooseCombinedIsolationDBSumPtCorr3Hits,
+     PFTauDisc_HPSPFTauDiscriminationByLooseIsolationMVA,
+     PFTauDisc_HPSPFTauDiscriminationByMediumIsolationMVA,
+     PFTauDisc_HPSPFTauDiscriminationByTightIsolationMVA,
+     PFTauDisc_HPSPFTauDiscriminationByLooseIsolationMVA2,
+     PFTauDisc_HPSPFTauDiscriminationByMediumIsolationMVA2,
+     PFTauDisc_HPSPFTauDiscriminationByTightIsolationMVA2,
+     NPFTauDiscriminators
+   };
+   static ULong64_t PFTauDiscMask(PFTauDiscriminator bit){return ULong64_t(1) << bit;}
+   // all discriminators of tau i packed into one word; a working point is checked by (mask & required) == required
+   ULong64_t PFTau_discriminatorMask(unsigned int i){if(!tauDiscMask_isFilled) FillTauDiscriminatorMasks(); return tauDiscMask.at(i);}
+   const std::vector<ULong64_t>& PFTau_discriminatorMasks(){if(!tauDiscMask_isFilled) FillTauDiscriminatorMasks(); return tauDiscMask;}
+   bool PFTau_passDiscriminators(unsigned int i, ULong64_t required){return (PFTau_discriminatorMask(i) & required) == required;}
+   bool PFTau_isTightIsolation(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isTightIsolation);}
+   bool PFTau_isMediumIsolation(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isMediumIsolation);}
+   bool PFTau_isLooseIsolation(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isLooseIsolation);}
+   bool PFTau_isTightIsolationDBSumPtCorr(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isTightIsolationDBSumPtCorr);}
+   bool PFTau_isMediumIsolationDBSumPtCorr(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isMediumIsolationDBSumPtCorr);}
+   bool PFTau_isLooseIsolationDBSumPtCorr(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isLooseIsolationDBSumPtCorr);}
+   bool PFTau_isVLooseIsolationDBSumPtCorr(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isVLooseIsolationDBSumPtCorr);}
+   bool PFTau_isHPSAgainstElectronsLoose(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstElectronsLoose);}
+   bool PFTau_isHPSAgainstElectronsMedium(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstElectronsMedium);}
+   bool PFTau_isHPSAgainstElectronsTight(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstElectronsTight);}
+   bool PFTau_isHPSAgainstMuonLoose(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstMuonLoose);}
+   bool PFTau_isHPSAgainstMuonMedium(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstMuonMedium);}
+   bool PFTau_isHPSAgainstMuonTight(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstMuonTight);}
+   bool PFTau_isHPSAgainstMuonLoose2(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstMuonLoose2);}
+   bool PFTau_isHPSAgainstMuonMedium2(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstMuonMedium2);}
+   bool PFTau_isHPSAgainstMuonTight2(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSAgainstMuonTight2);}
+   bool PFTau_isHPSByDecayModeFinding(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_isHPSByDecayModeFinding);}
+   bool PFTau_HPSPFTauDiscriminationByMVA3LooseElectronRejection(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByMVA3LooseElectronRejection);}
+   bool PFTau_HPSPFTauDiscriminationByMVA3MediumElectronRejection(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByMVA3MediumElectronRejection);}
+   bool PFTau_HPSPFTauDiscriminationByMVA3TightElectronRejection(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByMVA3TightElectronRejection);}
+   bool PFTau_HPSPFTauDiscriminationByMVA3VTightElectronRejection(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByMVA3VTightElectronRejection);}
+   bool PFTau_HPSPFTauDiscriminationByTightCombinedIsolationDBSumPtCorr3Hits(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByTightCombinedIsolationDBSumPtCorr3Hits);}
+   bool PFTau_HPSPFTauDiscriminationByMediumCombinedIsolationDBSumPtCorr3Hits(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByMediumCombinedIsolationDBSumPtCorr3Hits);}
+   bool PFTau_HPSPFTauDiscriminationByLooseCombinedIsolationDBSumPtCorr3Hits(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByLooseCombinedIsolationDBSumPtCorr3Hits);}
    float PFTau_HPSPFTauDiscriminationByRawCombinedIsolationDBSumPtCorr3Hits(unsigned int i){return Ntp->PFTau_HPSPFTauDiscriminationByRawCombinedIsolationDBSumPtCorr3Hits->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByLooseIsolationMVA(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByLooseIsolationMVA->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByMediumIsolationMVA(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByMediumIsolationMVA->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByTightIsolationMVA(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByTightIsolationMVA->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByLooseIsolationMVA2(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByLooseIsolationMVA2->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByMediumIsolationMVA2(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByMediumIsolationMVA2->at(i);}
-   bool PFTau_HPSPFTauDiscriminationByTightIsolationMVA2(unsigned int i){return  Ntp->PFTau_HPSPFTauDiscriminationByTightIsolationMVA2->at(i);}
+   bool PFTau_HPSPFTauDiscriminationByLooseIsolationMVA(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByLooseIsolationMVA);}
+   bool PFTau_HPSPFTauDiscriminationByMediumIsolationMVA(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByMediumIsolationMVA);}
+   bool PFTau_HPSPFTauDiscriminationByTightIsolationMVA(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByTightIsolationMVA);}
+   bool PFTau_HPSPFTauDiscriminationByLooseIsolationMVA2(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByLooseIsolationMVA2);}
+   bool PFTau_HPSPFTauDiscriminationByMediumIsolationMVA2(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByMediumIsolationMVA2);}
+   bool PFTau_HPSPFTauDiscriminationByTightIsolationMVA2(unsigned int i){return PFTau_discriminatorMask(i) & PFTauDiscMask(PFTauDisc_HPSPFTauDiscriminationByTightIsolationMVA2);}
    int PFTau_hpsDecayMode(unsigned int i){return  Ntp->PFTau_hpsDecayMode->at(i);}
    int PFTau_Charge(unsigned int i){return  Ntp->PFTau_Charge->at(i);}
    std::vector<int> PFTau_Track_idx(unsigned int i){return  Ntp->PFTau_Track_idx->at(i);}
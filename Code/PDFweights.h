@@ -8,8 +8,11 @@
 #ifndef PDFWEIGHTS_H_
 #define PDFWEIGHTS_H_
 
+#include <vector>
 #include "TString.h"
 #include "LHAPDF/LHAPDF.h"
+#include "ProductStore.h"
+#include "FNVHash.h"
 
 class PDFweights{
 public:
@@ -18,8 +21,9 @@ public:
 		LHAPDF::initPDFSet(1,_pdfname1.Data());
 		_pdfname2 = pdfname2; // typical PDFs: CT10nnlo, MSTW2008nlo68cl, NNPDF23_nnlo_as_0119_100
 		LHAPDF::initPDFSet(2,_pdfname2.Data());
+		_store = new ProductStore("PDFweights_" + _pdfname1 + "_" + _pdfname2, 1, numberOfMembers());
 	}
-	virtual ~PDFweights(){};
+	virtual ~PDFweights(){ delete _store; };
 
 	int numberOfMembers(){ return LHAPDF::numberPDF(2)+1; };
 
@@ -40,9 +44,25 @@ public:
 		return pdf2/pdf1;
 	}
 
+	// weights of all members for the event, computed once per campaign (see ProductStore)
+	const std::vector<double>& weights(UInt_t run, UInt_t lumi, UInt_t event, int id1, int id2, double x1, double x2, double scale){
+		_weights.resize(numberOfMembers());
+		ULong64_t inputHash = FNVHash::Start;
+		int id[2] = {id1, id2};
+		double v[3] = {x1, x2, scale};
+		inputHash = FNVHash::Add(inputHash, id, sizeof(id));
+		inputHash = FNVHash::Add(inputHash, v, sizeof(v));
+		if(_store->Get(run, lumi, event, inputHash, &_weights.at(0))) return _weights;
+		for(unsigned int member=0; member<_weights.size(); member++) _weights.at(member) = weight(id1, id2, x1, x2, scale, member);
+		_store->Put(run, lumi, event, inputHash, &_weights.at(0));
+		return _weights;
+	}
+
 private:
 	TString _pdfname1;
 	TString _pdfname2;
+	ProductStore *_store;
+	std::vector<double> _weights;
 };
 
 #endif /* PDFWEIGHTS_H_ */
@@ -0,0 +1,258 @@
+/*
+ * PlotRenderer.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "PlotRenderer.h"
+#include "Plots.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TMD5.h"
+#include "TBufferFile.h"
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+unsigned int PlotRenderer::DefaultWorkers = 1;
+
+PlotRenderer::PlotRenderer(TString name_, const std::vector<int>& colour_, const std::vector<TString>& legend_, unsigned int nWorkers_):
+	name(name_),
+	colour(colour_),
+	legend(legend_),
+	nWorkers(nWorkers_ > 0 ? nWorkers_ : 1)
+{
+}
+
+PlotRenderer::~PlotRenderer() {
+}
+
+void PlotRenderer::Add1D(const std::vector<TH1D>& histo, unsigned int index, bool significance){
+	Family f;
+	f.kind = significance ? Plot1DSig : Plot1D;
+	f.index = index;
+	f.h1 = &histo;
+	f.h2 = NULL;
+	f.h3 = NULL;
+	Add(f, histo.size() > 0 ? &histo.at(0) : NULL);
+}
+
+void PlotRenderer::Add2D(const std::vector<TH2D>& histo){
+	Family f;
+	f.kind = Plot2D;
+	f.index = 0;
+	f.h1 = NULL;
+	f.h2 = &histo;
+	f.h3 = NULL;
+	Add(f, histo.size() > 0 ? &histo.at(0) : NULL);
+}
+
+void PlotRenderer::Add3D(const std::vector<TH3F>& histo){
+	Family f;
+	f.kind = Plot3D;
+	f.index = 0;
+	f.h1 = NULL;
+	f.h2 = NULL;
+	f.h3 = &histo;
+	Add(f, histo.size() > 0 ? &histo.at(0) : NULL);
+}
+
+void PlotRenderer::Add(Family f, const TH1* first){
+	if(first == NULL) return; // nothing to draw
+	f.name = first->GetName();
+	f.key = "";
+	f.key += (int) f.kind;
+	f.key += ":";
+	f.key += f.index;
+	f.key += ":";
+	f.key += f.name;
+	families.push_back(f);
+}
+
+// MD5 of the streamed histograms and of everything else which changes the plots
+TString PlotRenderer::Hash(const Family& f) const {
+	TMD5 md5;
+	TString opts = f.key + ":" + Plots::Get_Plot_Type();
+	for(unsigned int i=0; i<colour.size(); i++){
+		opts += ":";
+		opts += colour.at(i);
+	}
+	for(unsigned int i=0; i<legend.size(); i++) opts += ":" + legend.at(i);
+	md5.Update((const UChar_t*) opts.Data(), opts.Length());
+	std::vector<TH1*> histos;
+	if(f.h1) for(unsigned int i=0; i<f.h1->size(); i++) histos.push_back(const_cast<TH1D*>(&f.h1->at(i)));
+	if(f.h2) for(unsigned int i=0; i<f.h2->size(); i++) histos.push_back(const_cast<TH2D*>(&f.h2->at(i)));
+	if(f.h3) for(unsigned int i=0; i<f.h3->size(); i++) histos.push_back(const_cast<TH3F*>(&f.h3->at(i)));
+	for(unsigned int i=0; i<histos.size(); i++){
+		TBufferFile b(TBuffer::kWrite);
+		histos.at(i)->Streamer(b);
+		md5.Update((const UChar_t*) b.Buffer(), b.Length());
+	}
+	md5.Final();
+	return md5.AsString();
+}
+
+void PlotRenderer::Draw(Plots& P, Family& f){
+	P.TakePrinted();
+	if(f.kind == Plot1D || f.kind == Plot1DSig){
+		P.Plot1D(std::vector<std::vector<TH1D> >(1, *f.h1), colour, legend, f.index);
+		if(f.kind == Plot1DSig){
+			P.Plot1DSignificance(*f.h1, true, false, colour, legend);
+			P.Plot1DSignificance(*f.h1, false, true, colour, legend);
+			P.Plot1Dsigtobkg(*f.h1, true, false, colour, legend);
+			P.Plot1Dsigtobkg(*f.h1, false, true, colour, legend);
+			P.Plot1D_DataMC_Compare(*f.h1, colour, legend);
+		}
+	}
+	else if(f.kind == Plot2D){
+		P.Plot2D(*f.h2, colour, legend);
+	}
+	else if(f.kind == Plot3D){
+		P.Plot3D(*f.h3, colour, legend);
+	}
+	f.files = P.TakePrinted();
+	for(unsigned int i=0; i<f.files.size(); i++) f.files.at(i) = gSystem->BaseName(f.files.at(i));
+}
+
+void PlotRenderer::Render(TString dir){
+	TString manifest = dir + "." + name + ".manifest";
+	std::map<TString, ManifestEntry> previous = ReadManifest(manifest);
+	std::vector<bool> done(families.size(), false);
+	std::vector<bool> keep(families.size(), false);
+	std::vector<unsigned int> todo;
+	for(unsigned int f=0; f<families.size(); f++){
+		families.at(f).hash = Hash(families.at(f));
+		std::map<TString, ManifestEntry>::const_iterator it = previous.find(families.at(f).key);
+		if(it != previous.end() && it->second.hash == families.at(f).hash){
+			keep.at(f) = true;
+			done.at(f) = true;
+			families.at(f).files = it->second.files;
+		}
+		else{
+			todo.push_back(f);
+		}
+	}
+	RemoveStale(dir, previous, keep);
+	gSystem->Unlink(manifest); // not valid while drawing
+
+	unsigned int nw = nWorkers < todo.size() ? nWorkers : todo.size();
+	Logger(Logger::Info) << "Drawing " << todo.size() << " of " << families.size() << " plot families ("
+			<< families.size() - todo.size() << " unchanged) with " << (nw > 1 ? nw : 1) << " workers" << std::endl;
+	if(nw > 1){
+		RenderInWorkers(dir, todo, nw, done);
+	}
+	else{
+		Plots P;
+		for(unsigned int i=0; i<todo.size(); i++){
+			Draw(P, families.at(todo.at(i)));
+			done.at(todo.at(i)) = true;
+		}
+	}
+	WriteManifest(manifest, done);
+}
+
+// worker w draws the families todo[w], todo[w+nw], ...; families of failed workers are
+// left out of the manifest and drawn again in the next run. The EPS files drawn by a worker
+// are reported in <dir>.<name>.files<w>
+void PlotRenderer::RenderInWorkers(TString dir, const std::vector<unsigned int>& todo, unsigned int nw, std::vector<bool>& done){
+	// buffered output would be written by every worker otherwise
+	fflush(stdout);
+	std::cout.flush();
+	std::vector<pid_t> pids;
+	std::vector<TString> reports;
+	for(unsigned int w=0; w<nw; w++){
+		TString report = dir + "." + name + ".files";
+		report += w;
+		reports.push_back(report);
+		pid_t pid = fork();
+		if(pid == 0){
+			gROOT->SetBatch(kTRUE);
+			Plots P;
+			std::ofstream out(report.Data());
+			for(unsigned int i=w; i<todo.size(); i+=nw){
+				Family& f = families.at(todo.at(i));
+				Draw(P, f);
+				for(unsigned int k=0; k<f.files.size(); k++) out << todo.at(i) << " " << f.files.at(k) << std::endl;
+			}
+			out.close();
+			fflush(stdout);
+			std::cout.flush();
+			_exit(out.fail() ? 1 : 0);
+		}
+		if(pid < 0){
+			Logger(Logger::Warning) << "fork failed for plot worker " << w << ", drawing its plots in this process." << std::endl;
+			Plots P;
+			for(unsigned int i=w; i<todo.size(); i+=nw){
+				Draw(P, families.at(todo.at(i)));
+				done.at(todo.at(i)) = true;
+			}
+		}
+		pids.push_back(pid);
+	}
+
+	for(unsigned int w=0; w<pids.size(); w++){
+		if(pids.at(w) <= 0) continue;
+		int status = 1;
+		waitpid(pids.at(w), &status, 0);
+		if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+			Logger(Logger::Error) << "Plot worker " << w << " failed, some plots may be missing." << std::endl;
+			gSystem->Unlink(reports.at(w));
+			continue;
+		}
+		std::ifstream in(reports.at(w).Data());
+		unsigned int f;
+		std::string file;
+		while(in >> f >> file){
+			if(f < families.size()) families.at(f).files.push_back(file.c_str());
+		}
+		in.close();
+		gSystem->Unlink(reports.at(w));
+		for(unsigned int i=w; i<todo.size(); i+=nw) done.at(todo.at(i)) = true;
+	}
+}
+
+// one line per family: <key> <hash> <EPS files>
+std::map<TString, PlotRenderer::ManifestEntry> PlotRenderer::ReadManifest(TString file){
+	std::map<TString, ManifestEntry> m;
+	std::ifstream in(file.Data());
+	std::string line;
+	while(std::getline(in, line)){
+		std::istringstream s(line);
+		std::string key, hash, eps;
+		if(!(s >> key >> hash)) continue;
+		ManifestEntry& e = m[key.c_str()];
+		e.hash = hash.c_str();
+		while(s >> eps) e.files.push_back(eps.c_str());
+	}
+	return m;
+}
+
+void PlotRenderer::WriteManifest(TString file, const std::vector<bool>& done){
+	std::ofstream out(file.Data());
+	for(unsigned int f=0; f<families.size(); f++){
+		if(!done.at(f)) continue;
+		out << families.at(f).key << " " << families.at(f).hash;
+		for(unsigned int i=0; i<families.at(f).files.size(); i++) out << " " << families.at(f).files.at(i);
+		out << std::endl;
+	}
+}
+
+// remove the EPS files which the previous manifest lists for families that are drawn again or
+// no longer exist; files of kept families and files not drawn by this selection are not touched
+void PlotRenderer::RemoveStale(TString dir, const std::map<TString, ManifestEntry>& previous, const std::vector<bool>& keep){
+	std::set<TString> kept;
+	for(unsigned int f=0; f<families.size(); f++){
+		if(keep.at(f)) kept.insert(families.at(f).files.begin(), families.at(f).files.end());
+	}
+	for(std::map<TString, ManifestEntry>::const_iterator it = previous.begin(); it != previous.end(); it++){
+		for(unsigned int i=0; i<it->second.files.size(); i++){
+			if(kept.count(it->second.files.at(i)) == 0) gSystem->Unlink(dir + it->second.files.at(i));
+		}
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * PlotRenderer.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Renders the EPS plots of Selection::Finish in forked worker processes.
+ *
+ *      A family is one histogram of all types (e.g. Nminus1.at(i) or
+ *      *Extradist1d.at(i)) together with all plots made from it. Families
+ *      are distributed round-robin over the workers; each worker draws with
+ *      its own Plots object and batch mode canvases, the file names are the
+ *      same as for serial plotting.
+ *      The MD5 of the streamed histograms (plus colours, legend, plot style,
+ *      label and options) of each family is kept with the EPS files drawn
+ *      for it in the manifest of the selection, <dir>.<name>.manifest. A
+ *      family whose hash did not change since the last run is not drawn
+ *      again and its EPS files are kept. Only the EPS files listed in the
+ *      selection's previous manifest for changed or vanished families are
+ *      removed, plots of other selections are never touched.
+ *      Delete the manifest to force all plots to be redrawn.
+ */
+
+#ifndef PLOTRENDERER_H_
+#define PLOTRENDERER_H_
+
+#include <vector>
+#include <map>
+#include "TString.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TH3F.h"
+
+class Plots;
+
+class PlotRenderer {
+public:
+	// name: name of the selection, used for the manifest
+	PlotRenderer(TString name, const std::vector<int>& colour, const std::vector<TString>& legend, unsigned int nWorkers = DefaultWorkers);
+	virtual ~PlotRenderer();
+
+	// the histograms are not copied and have to exist until Render() returns
+	// index: index in the EPS file name of Plots::Plot1D, significance: also draw the
+	// significance, signal/background and data/MC plots
+	void Add1D(const std::vector<TH1D>& histo, unsigned int index, bool significance);
+	void Add2D(const std::vector<TH2D>& histo);
+	void Add3D(const std::vector<TH3F>& histo);
+
+	// draw all families which changed into dir (as used by Plots)
+	void Render(TString dir = "EPS/");
+
+	// number of worker processes used by default (set e.g. from "PlotWorkers:" in Input.txt)
+	static void SetDefaultWorkers(unsigned int n){DefaultWorkers = n > 0 ? n : 1;}
+	static unsigned int GetDefaultWorkers(){return DefaultWorkers;}
+
+private:
+	enum Kind {Plot1D = 0, Plot1DSig, Plot2D, Plot3D};
+
+	struct Family {
+		Kind kind;
+		unsigned int index;
+		const std::vector<TH1D> *h1;
+		const std::vector<TH2D> *h2;
+		const std::vector<TH3F> *h3;
+		TString name; // name of the first histogram, prefix of all EPS files of the family
+		TString key;  // manifest key
+		TString hash;
+		std::vector<TString> files; // EPS files (without dir)
+	};
+	struct ManifestEntry {
+		TString hash;
+		std::vector<TString> files;
+	};
+
+	void Add(Family f, const TH1* first);
+	TString Hash(const Family& f) const;
+	void Draw(Plots& P, Family& f);
+	void RenderInWorkers(TString dir, const std::vector<unsigned int>& todo, unsigned int nw, std::vector<bool>& done);
+	std::map<TString, ManifestEntry> ReadManifest(TString file);
+	void WriteManifest(TString file, const std::vector<bool>& done);
+	void RemoveStale(TString dir, const std::map<TString, ManifestEntry>& previous, const std::vector<bool>& keep);
+
+	TString name;
+	std::vector<int> colour;
+	std::vector<TString> legend;
+	unsigned int nWorkers;
+	std::vector<Family> families;
+
+	static unsigned int DefaultWorkers;
+};
+
+#endif /* PLOTRENDERER_H_ */
@@ -13,6 +13,7 @@
 #include <iostream>
 
 int Plots::plotLabel = 0;
+TString Plots::plotType;
 TString Plots::File_;
 std::vector<TString> Plots::HistogramNames_;
 
@@ -27,6 +28,7 @@ Plots::~Plots() {
 void Plots::Set_Plot_Type(TString style, TString label) {
 	style.ToLower();
 	label.ToLower();
+	plotType = style + ":" + label;
 	if (label.Contains("internal"))
 		plotLabel = cmsInternal;
 	if (label.Contains("private"))
@@ -44,6 +46,18 @@ void Plots::Set_Plot_Type(TString style, TString label) {
 	}
 }
 
+// print the canvas and remember the file, see TakePrinted
+void Plots::Print(TCanvas& c, TString file) {
+	c.Print(file);
+	printed.push_back(file);
+}
+
+std::vector<TString> Plots::TakePrinted() {
+	std::vector<TString> files;
+	files.swap(printed);
+	return files;
+}
+
 void Plots::Plot1D(std::vector<TH1D> histo, std::vector<int> colour, std::vector<TString> legend) {
 	std::vector<std::vector<TH1D> > histos;
 	histos.push_back(histo);
@@ -55,7 +69,7 @@ void Plots::SaveHistograms(TString File, std::vector<TString> HistogramNames) {
 	HistogramNames_ = HistogramNames;
 }
 
-void Plots::Plot1D(std::vector<std::vector<TH1D> > histo, std::vector<int> colour, std::vector<TString> legend) {
+void Plots::Plot1D(std::vector<std::vector<TH1D> > histo, std::vector<int> colour, std::vector<TString> legend, unsigned int firstIndex) {
 
 	Logger(Logger::Verbose) << "Create 1D plots" << std::endl;
 	TCanvas canv("canv", "canv", 200, 10, 750, 750);
@@ -252,7 +266,7 @@ void Plots::Plot1D(std::vector<std::vector<TH1D> > histo, std::vector<int> colou
 					filename += "_log";
 				}
 				filename += "_index_";
-				filename += i_plot;
+				filename += firstIndex + i_plot;
 				// filename including folder structure and type
 				TString EPSName = "EPS/";
 				EPSName += filename;
@@ -260,7 +274,7 @@ void Plots::Plot1D(std::vector<std::vector<TH1D> > histo, std::vector<int> colou
 
 				// save plot only if it is linear OR ( logarithmic AND ( Nminus plot OR Accumdist plot) )
 				if (linlog == 0 || !filename.Contains("Nminus") || filename.Contains("Accumdist")) {
-					canv.Print(EPSName);
+					Print(canv, EPSName);
 				}
 
 				// save some histograms in extra root file
@@ -349,7 +363,7 @@ void Plots::Plot1DSignificance(std::vector<TH1D> histo, bool gt, bool lt, std::v
 		EPSName += ".eps";
 
 		if (!name.Contains("Accumdist")) {
-			c.Print(EPSName);
+			Print(c, EPSName);
 			int bmax = histo.at(0).GetMaximumBin();
 			if (gt)
 				bmax += 1;
@@ -443,7 +457,7 @@ void Plots::Plot1Dsigtobkg(std::vector<TH1D> histo, bool gt, bool lt, std::vecto
 		EPSName += name;
 		EPSName += ".eps";
 		if (!name.Contains("Accumdist")) {
-			c.Print(EPSName);
+			Print(c, EPSName);
 		}
 	}
 	Logger(Logger::Verbose) << "Plots::Plot1Dsigtobkg done" << std::endl;
@@ -512,7 +526,7 @@ void Plots::Plot1D_DataMC_Compare(std::vector<TH1D> histo, std::vector<int> colo
 		EPSName += name;
 		EPSName += ".eps";
 		if (!name.Contains("Accumdist")) {
-			c.Print(EPSName);
+			Print(c, EPSName);
 		}
 		///////////////////////////////////////////////////////////////////////////////////////////////////////
 		histo.at(1).SetYTitle("Data-MC");
@@ -533,7 +547,7 @@ void Plots::Plot1D_DataMC_Compare(std::vector<TH1D> histo, std::vector<int> colo
 		EPSName += name;
 		EPSName += ".eps";
 		if (!name.Contains("Accumdist")) {
-			c.Print(EPSName);
+			Print(c, EPSName);
 		}
 
 	}
@@ -651,7 +665,7 @@ void Plots::Plot2D(std::vector<TH2D> histo, std::vector<int> colour, std::vector
 			EPSName += name;
 			EPSName += nPlotted;
 			EPSName += ".eps";
-			c.Print(EPSName);
+			Print(c, EPSName);
 
 			nPlotted += 6;
 		}
@@ -722,7 +736,7 @@ void Plots::Plot3D(std::vector<TH3F> histo, std::vector<int> colour, std::vector
 		EPSName = "EPS/";
 		EPSName += name;
 		EPSName += ".eps";
-		c.Print(EPSName);
+		Print(c, EPSName);
 		Logger(Logger::Debug) << "Histo 3D " << EPSName << std::endl;
 	}
 }
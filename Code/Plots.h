@@ -22,6 +22,7 @@ class Plots {
  enum PLOTTYPE {cmsStyle1,cmsStyle2};
 
  void Set_Plot_Type(TString style, TString label);
+ static TString Get_Plot_Type(){return plotType;}
  void SaveHistograms(TString File, std::vector<TString> HistogramNames);
 
  void CMSStyle1();
@@ -30,7 +31,8 @@ class Plots {
  void CMSLabel(Double_t x,Double_t y,Color_t color);
 
  void Plot1D(std::vector<TH1D> histo,std::vector<int> colour,std::vector<TString> legend);
- void Plot1D(std::vector<std::vector<TH1D> > histo,std::vector<int> colour,std::vector<TString> legend);
+ // firstIndex: index of histo.at(0) in the EPS file names (_index_<i>)
+ void Plot1D(std::vector<std::vector<TH1D> > histo,std::vector<int> colour,std::vector<TString> legend,unsigned int firstIndex=0);
  void Plot2D(std::vector<TH2D>  histo,std::vector<int> colour,std::vector<TString> legend);
  void Plot3D(std::vector<TH3F>  histo,std::vector<int> colour,std::vector<TString> legend);
  void Make_Figure(TString name,TString cap);
@@ -38,10 +40,17 @@ class Plots {
  void Plot1Dsigtobkg(std::vector<TH1D> histo, bool gt,bool lt,std::vector<int> colour,std::vector<TString> legend);
  void Plot1D_DataMC_Compare(std::vector<TH1D> histo,std::vector<int> colour,std::vector<TString> legend);
 
+ // EPS files printed since the last call
+ std::vector<TString> TakePrinted();
+
  private:
+ void Print(TCanvas& c, TString file);
+
  static TString File_;
  static std::vector<TString> HistogramNames_;
  static int plotLabel;
+ static TString plotType; // style and label as set by Set_Plot_Type
+ std::vector<TString> printed;
  bool doscale;
  bool doprofiles;
  bool dooneprofile;
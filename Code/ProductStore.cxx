@@ -0,0 +1,191 @@
+/*
+ * ProductStore.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ProductStore.h"
+#include "FNVHash.h"
+#include "Parameters.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TSystem.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+namespace {
+const char StoreMagic[8] = {'P', 'R', 'O', 'D', 'S', 'T', 'O', 'R'};
+const UInt_t FormatVersion = 2;
+}
+
+ProductStore::ProductStore(TString schema, UInt_t version, unsigned int nValues):
+	schema_(schema),
+	version_(version),
+	nValues_(nValues),
+	file_(""),
+	opened_(false),
+	flushEvery_(0),
+	nSegmentsWritten_(0),
+	main_(StoreMagic, FormatVersion, sizeof(Key) + nValues * sizeof(double)),
+	nStored_(0),
+	nComputed_(0)
+{
+	// the store is opened at first use, i.e. after the parameters are configured
+}
+
+ProductStore::~ProductStore() {
+	Flush();
+	CloseSegments();
+	if(opened_) Logger(Logger::Verbose) << schema_ << ": " << nStored_ << " results read from the store, " << nComputed_ << " computed" << std::endl;
+}
+
+// files of another producer or number of values are not used
+ULong64_t ProductStore::Signature() const {
+	TString s = schema_ + ":";
+	s += version_;
+	s += ":";
+	s += nValues_;
+	return FNVHash::Add(FNVHash::Start, s);
+}
+
+void ProductStore::Open(){
+	if(opened_) return;
+	opened_ = true;
+	Parameters Par; // assumes configured in Analysis.cxx
+	TString dir;
+	int flushEvery;
+	Par.GetString("ProductStoreDir:", dir, "");
+	Par.GetInt("ProductStoreFlushEvery:", flushEvery, 10000);
+	flushEvery_ = flushEvery > 0 ? flushEvery : 1;
+	if(dir == "") return;
+	file_ = dir + "/" + schema_ + "_v";
+	file_ += version_;
+	file_ += ".bin";
+	main_.Open(file_, Signature());
+	OpenSegments();
+	ULong64_t n = main_.GetNRecords();
+	for(unsigned int i=0; i<segments_.size(); i++) n += segments_.at(i)->GetNRecords();
+	if(n > 0) Logger(Logger::Info) << "Using " << n << " stored results of " << schema_ << " (version " << version_ << ") from " << file_ << " and " << segments_.size() << " segments" << std::endl;
+}
+
+// map all segments of the store which are complete (renamed)
+void ProductStore::OpenSegments(){
+	CloseSegments();
+	TString prefix = TString(gSystem->BaseName(file_)) + ".seg_";
+	void *d = gSystem->OpenDirectory(gSystem->DirName(file_));
+	const char *entry;
+	while(d != NULL && (entry = gSystem->GetDirEntry(d))){
+		TString name = entry;
+		if(!name.BeginsWith(prefix) || name.Contains(".tmp")) continue;
+		KeyedRecordFile *seg = new KeyedRecordFile(StoreMagic, FormatVersion, RecordSize());
+		if(seg->Open(TString(gSystem->DirName(file_)) + "/" + name, Signature())) segments_.push_back(seg);
+		else delete seg; // removed by a compaction in the meantime
+	}
+	if(d != NULL) gSystem->FreeDirectory(d);
+}
+
+void ProductStore::CloseSegments(){
+	for(unsigned int i=0; i<segments_.size(); i++) delete segments_.at(i);
+	segments_.clear();
+}
+
+const char* ProductStore::Find(const Key& k) const {
+	const char *r = main_.Find(k.run, k.lumi, k.event, k.inputHash);
+	for(unsigned int i=0; r == NULL && i<segments_.size(); i++) r = segments_.at(i)->Find(k.run, k.lumi, k.event, k.inputHash);
+	return r;
+}
+
+bool ProductStore::Get(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, double* values){
+	Open();
+	Key k = {run, lumi, event, 0, inputHash};
+	std::map<Key, std::vector<double> >::const_iterator it = new_.find(k);
+	if(it != new_.end()){
+		memcpy(values, &it->second.at(0), nValues_ * sizeof(double));
+		return true;
+	}
+	const char *r = Find(k);
+	if(r == NULL) return false;
+	memcpy(values, r + sizeof(Key), nValues_ * sizeof(double));
+	nStored_++;
+	return true;
+}
+
+void ProductStore::Put(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, const double* values){
+	Open();
+	Key k = {run, lumi, event, 0, inputHash};
+	if(new_.count(k) > 0) return;
+	new_[k] = std::vector<double>(values, values + nValues_);
+	nComputed_++;
+	if(new_.size() >= flushEvery_) Flush();
+}
+
+void ProductStore::Flush(){
+	if(file_ == "" || new_.size() == 0) return;
+	gSystem->mkdir(gSystem->DirName(file_), kTRUE);
+	TString lockFile = file_ + ".lock";
+	int lock = open(lockFile.Data(), O_RDWR | O_CREAT, 0666);
+	if(lock >= 0) flock(lock, LOCK_EX);
+
+	// results added by other jobs in the meantime are not written again
+	main_.Open(file_, Signature());
+	OpenSegments();
+	std::vector<char> records;
+	ULong64_t nAdded = 0;
+	for(std::map<Key, std::vector<double> >::const_iterator it = new_.begin(); it != new_.end(); ++it){
+		if(Find(it->first) != NULL) continue;
+		const char *k = (const char*) &it->first;
+		const char *v = (const char*) &it->second.at(0);
+		records.insert(records.end(), k, k + sizeof(Key));
+		records.insert(records.end(), v, v + nValues_ * sizeof(double));
+		nAdded++;
+	}
+	bool ok = true;
+	if(nAdded > 0){
+		TString segment = file_ + ".seg_" + gSystem->HostName() + "_";
+		segment += getpid();
+		segment += "_";
+		segment += nSegmentsWritten_++;
+		ok = main_.Write(segment, Signature(), &records.at(0), nAdded) >= 0;
+		if(ok) OpenSegments();
+		if(ok && segments_.size() > MaxSegments) Compact();
+	}
+	if(lock >= 0){
+		flock(lock, LOCK_UN);
+		close(lock);
+	}
+	if(!ok){
+		Logger(Logger::Error) << "Results of " << schema_ << " could not be stored in " << file_ << ", they are kept in memory." << std::endl;
+		return;
+	}
+	new_.clear();
+	Logger(Logger::Info) << "Added " << nAdded << " results of " << schema_ << " to " << file_ << std::endl;
+}
+
+// merge the main file and all segments into the main file, called with the store locked
+void ProductStore::Compact(){
+	ULong64_t nRecords = main_.GetNRecords();
+	for(unsigned int i=0; i<segments_.size(); i++) nRecords += segments_.at(i)->GetNRecords();
+	std::vector<char> records;
+	records.reserve(nRecords * RecordSize());
+	if(main_.GetNRecords() > 0) records.assign(main_.GetRecord(0), main_.GetRecord(main_.GetNRecords()));
+	for(unsigned int i=0; i<segments_.size(); i++){
+		if(segments_.at(i)->GetNRecords() > 0) records.insert(records.end(), segments_.at(i)->GetRecord(0), segments_.at(i)->GetRecord(segments_.at(i)->GetNRecords()));
+	}
+	if(main_.Write(file_, Signature(), nRecords > 0 ? &records.at(0) : NULL, nRecords) < 0) return; // segments are kept
+	// the segments are in the main file now
+	void *d = gSystem->OpenDirectory(gSystem->DirName(file_));
+	TString prefix = TString(gSystem->BaseName(file_)) + ".seg_";
+	std::vector<TString> merged;
+	const char *entry;
+	while(d != NULL && (entry = gSystem->GetDirEntry(d))){
+		TString name = entry;
+		if(name.BeginsWith(prefix) && !name.Contains(".tmp")) merged.push_back(TString(gSystem->DirName(file_)) + "/" + name);
+	}
+	if(d != NULL) gSystem->FreeDirectory(d);
+	for(unsigned int i=0; i<merged.size(); i++) gSystem->Unlink(merged.at(i));
+	CloseSegments();
+	main_.Open(file_, Signature());
+	Logger(Logger::Info) << "Compacted " << merged.size() << " segments of " << schema_ << " into " << file_ << " (" << main_.GetNRecords() << " results)" << std::endl;
+}
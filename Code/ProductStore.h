@@ -0,0 +1,84 @@
+/*
+ * ProductStore.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Keyed sidecar store of expensive, deterministic per-event products
+ *      (e.g. TauSpinner weights, PDF weights of all members).
+ *
+ *      A producer registers a schema (name), a version and the number of
+ *      values of its results. Results are stored with the event (run, lumi,
+ *      event) and a hash of the producer inputs (see FNVHash), so e.g.
+ *      variations with unchanged inputs find the nominal result. Results
+ *      computed in a job are available immediately (Get) and are added to
+ *      the store in "ProductStoreDir:" every "ProductStoreFlushEvery:"
+ *      results (default 10000) and at the end of the job (Flush), so all
+ *      later jobs of the campaign read them back instead of recomputing them.
+ *      Without "ProductStoreDir:" results are only kept within the job.
+ *
+ *      The store is the KeyedRecordFile <schema>_v<version>.bin, each record
+ *      being a KeyedRecordFile::Key and double values[nValues], and segment
+ *      files <schema>_v<version>.bin.seg_<host>_<pid>_<n> of the same format.
+ *      A flush only writes the new results as a segment; when there are more
+ *      than MaxSegments segments, they are compacted into the main file.
+ *      A new producer version uses new files, i.e. results of older versions
+ *      are never read. Jobs adding results lock the store (<file>.lock), all
+ *      files are replaced by renaming, readers never see a partial file.
+ */
+
+#ifndef PRODUCTSTORE_H_
+#define PRODUCTSTORE_H_
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include "Rtypes.h"
+#include "TString.h"
+#include "KeyedRecordFile.h"
+
+class ProductStore {
+public:
+	// version: to be increased whenever the results of the producer change
+	ProductStore(TString schema, UInt_t version, unsigned int nValues);
+	virtual ~ProductStore();
+
+	// fill values (nValues) with the stored result, false if it is not known
+	bool Get(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, double* values);
+	// store a result computed in this job
+	void Put(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, const double* values);
+	// add the results of this job which are not stored yet to the store (also done by the destructor)
+	void Flush();
+
+	const TString& GetSchema() const {return schema_;}
+	unsigned int GetNValues() const {return nValues_;}
+
+private:
+	typedef KeyedRecordFile::Key Key;
+
+	void Open();
+	void OpenSegments();
+	void CloseSegments();
+	const char* Find(const Key& k) const;
+	void Compact();
+	size_t RecordSize() const {return sizeof(Key) + nValues_ * sizeof(double);}
+	ULong64_t Signature() const;
+
+	TString schema_;
+	UInt_t version_;
+	unsigned int nValues_;
+	TString file_;   // "": results are kept in this job only
+	bool opened_;
+	unsigned int flushEvery_;
+	unsigned int nSegmentsWritten_;
+
+	KeyedRecordFile main_;
+	std::vector<KeyedRecordFile*> segments_;
+
+	std::map<Key, std::vector<double> > new_; // computed in this job, not yet in the store
+	unsigned int nStored_, nComputed_;
+
+	// segments before they are compacted into the main file
+	static const unsigned int MaxSegments = 16;
+};
+
+#endif /* PRODUCTSTORE_H_ */
@@ -0,0 +1,179 @@
+/*
+ * SVFitCache.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SVFitCache.h"
+#include "SVFitObject.h"
+#include "FNVHash.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TTree.h"
+#include <vector>
+#include <cstring>
+
+namespace {
+const char CacheMagic[8] = {'S', 'V', 'F', 'C', 'A', 'C', 'H', 'E'};
+const UInt_t CacheVersion = 1;
+
+void copyString(char* dest, size_t size, const TString& s){
+	strncpy(dest, s.Data(), size - 1);
+	dest[size - 1] = '\0';
+}
+}
+
+SVFitCache::SVFitCache():
+	file_(CacheMagic, CacheVersion, sizeof(Record))
+{
+}
+
+SVFitCache::~SVFitCache() {
+}
+
+void SVFitCache::Close(){
+	file_.Close();
+}
+
+ULong64_t SVFitCache::GetNEntries() const {
+	return file_.GetNRecords();
+}
+
+ULong64_t SVFitCache::Signature(const TString& s){
+	return FNVHash::Add(FNVHash::Start, s);
+}
+
+bool SVFitCache::Open(TString file, ULong64_t signature){
+	if(!file_.Open(file, signature)) return false;
+	Logger(Logger::Verbose) << "Mapped SVFit cache " << file << " with " << file_.GetNRecords() << " results" << std::endl;
+	return true;
+}
+
+Long64_t SVFitCache::ReadTree(TTree* tree, std::vector<Record>& records){
+	UInt_t run, lumi, event;
+	ULong64_t inputHash = 0;
+	SVFitObject *obj = NULL;
+	tree->SetBranchAddress("RunNumber", &run);
+	tree->SetBranchAddress("LumiNumber", &lumi);
+	tree->SetBranchAddress("EventNumber", &event);
+	tree->SetBranchAddress("svfit", &obj);
+	// files written before the input hash was stored: matched by event only
+	if(tree->GetBranch("InputHash")) tree->SetBranchAddress("InputHash", &inputHash);
+
+	// read the tree once sequentially
+	Long64_t nEntries = tree->GetEntries();
+	Long64_t nRead = 0;
+	records.reserve(records.size() + nEntries);
+	for(Long64_t i=0; i<nEntries; i++){
+		if(tree->GetEntry(i) <= 0 || obj == NULL) continue;
+		Record r;
+		memset(&r, 0, sizeof(Record)); // also the padding, records are compared with memcmp
+		ToRecord(*obj, r);
+		r.run = run;
+		r.lumi = lumi;
+		r.event = event;
+		r.inputHash = inputHash;
+		records.push_back(r);
+		nRead++;
+	}
+	tree->ResetBranchAddresses();
+	delete obj;
+	return nRead;
+}
+
+bool SVFitCache::Build(TString file, ULong64_t signature, TTree* tree){
+	Close();
+	std::vector<Record> records;
+	ReadTree(tree, records);
+
+	Long64_t nDuplicates = file_.Write(file, signature, records.size() > 0 ? &records.at(0) : NULL, records.size());
+	if(nDuplicates < 0){
+		Logger(Logger::Error) << "Could not write SVFit cache " << file << std::endl;
+		return false;
+	}
+	Logger(Logger::Info) << "Built SVFit cache " << file << " with " << records.size() << " results (" << nDuplicates << " duplicates)" << std::endl;
+	return Open(file, signature);
+}
+
+bool SVFitCache::Get(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, SVFitObject& obj) const {
+	const Record *r = (const Record*) file_.Find(run, lumi, event, inputHash);
+	if(r == NULL) return false;
+	FromRecord(*r, obj);
+	return true;
+}
+
+void SVFitCache::ToRecord(const SVFitObject& obj, Record& r){
+	r.mass = obj.get_mass();
+	r.massUncert = obj.get_massUncert();
+	r.pt = obj.get_pt();
+	r.ptUncert = obj.get_ptUncert();
+	r.eta = obj.get_eta();
+	r.etaUncert = obj.get_etaUncert();
+	r.phi = obj.get_phi();
+	r.phiUncert = obj.get_phiUncert();
+	r.massLmax = obj.get_massLmax();
+	r.ptLmax = obj.get_ptLmax();
+	r.etaLmax = obj.get_etaLmax();
+	r.phiLmax = obj.get_phiLmax();
+	const std::vector<SVFitObject::LorentzVector>& fitted = obj.get_fittedTauLeptons();
+	const std::vector<SVFitObject::LorentzVector>& measured = obj.get_measuredTauLeptons();
+	r.nTaus = fitted.size() < 2 ? fitted.size() : 2;
+	for(unsigned int i=0; i<r.nTaus; i++){
+		r.fittedTaus[i][0] = fitted.at(i).Px();
+		r.fittedTaus[i][1] = fitted.at(i).Py();
+		r.fittedTaus[i][2] = fitted.at(i).Pz();
+		r.fittedTaus[i][3] = fitted.at(i).E();
+		if(i < measured.size()){
+			r.measuredTaus[i][0] = measured.at(i).Px();
+			r.measuredTaus[i][1] = measured.at(i).Py();
+			r.measuredTaus[i][2] = measured.at(i).Pz();
+			r.measuredTaus[i][3] = measured.at(i).E();
+		}
+	}
+	r.fittedMET[0] = obj.get_fittedMET().X();
+	r.fittedMET[1] = obj.get_fittedMET().Y();
+	r.fittedMET[2] = obj.get_fittedMET().Z();
+	r.measuredMET[0] = obj.get_measuredMET().X();
+	r.measuredMET[1] = obj.get_measuredMET().Y();
+	r.measuredMET[2] = obj.get_measuredMET().Z();
+	r.valid = obj.isValid();
+	r.addLogM = obj.get_addLogM();
+	r.maxObjFunctionCalls = obj.get_maxObjFunctionCalls();
+	r.metPower = obj.get_metPower();
+	copyString(r.fitMethod, sizeof(r.fitMethod), obj.get_fitMethod());
+	copyString(r.tauCorr, sizeof(r.tauCorr), obj.get_tauCorr());
+	copyString(r.muonCorr, sizeof(r.muonCorr), obj.get_muonCorr());
+	copyString(r.elecCorr, sizeof(r.elecCorr), obj.get_elecCorr());
+	copyString(r.metType, sizeof(r.metType), obj.get_metType());
+}
+
+void SVFitCache::FromRecord(const Record& r, SVFitObject& obj){
+	obj.valid_ = r.valid;
+	obj.fitMethod_ = r.fitMethod;
+	obj.mass_ = r.mass;
+	obj.massUncert_ = r.massUncert;
+	obj.pt_ = r.pt;
+	obj.ptUncert_ = r.ptUncert;
+	obj.eta_ = r.eta;
+	obj.etaUncert_ = r.etaUncert;
+	obj.phi_ = r.phi;
+	obj.phiUncert_ = r.phiUncert;
+	obj.massLmax_ = r.massLmax;
+	obj.ptLmax_ = r.ptLmax;
+	obj.etaLmax_ = r.etaLmax;
+	obj.phiLmax_ = r.phiLmax;
+	obj.fittedTauLeptons_.clear();
+	obj.measuredTauLeptons_.clear();
+	for(unsigned int i=0; i<r.nTaus; i++){
+		obj.fittedTauLeptons_.push_back(SVFitObject::LorentzVector(r.fittedTaus[i][0], r.fittedTaus[i][1], r.fittedTaus[i][2], r.fittedTaus[i][3]));
+		obj.measuredTauLeptons_.push_back(SVFitObject::LorentzVector(r.measuredTaus[i][0], r.measuredTaus[i][1], r.measuredTaus[i][2], r.measuredTaus[i][3]));
+	}
+	obj.fittedMET_ = SVFitObject::Vector(r.fittedMET[0], r.fittedMET[1], r.fittedMET[2]);
+	obj.measuredMET_ = SVFitObject::Vector(r.measuredMET[0], r.measuredMET[1], r.measuredMET[2]);
+	obj.tauCorr_ = r.tauCorr;
+	obj.muonCorr_ = r.muonCorr;
+	obj.elecCorr_ = r.elecCorr;
+	obj.metType_ = r.metType;
+	obj.addLogM_ = r.addLogM;
+	obj.maxObjFunctionCalls_ = r.maxObjFunctionCalls;
+	obj.metPower_ = r.metPower;
+}
@@ -0,0 +1,82 @@
+/*
+ * SVFitCache.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Read-only, memory-mapped lookup table of SVfit results.
+ *
+ *      The cache file is a KeyedRecordFile of fixed size plain-data records
+ *      (no ROOT objects), indexed on (run, lumi, event, input hash). It is
+ *      built once from the SVFitStorage input tree and then mapped read-only,
+ *      so a lookup is a few memory accesses without ROOT I/O, and all
+ *      processes on a node which map the same file share its pages.
+ *      If a result is stored more than once, the last one in the tree is used
+ *      (as in SVFitStorage::Compact).
+ */
+
+#ifndef SVFITCACHE_H_
+#define SVFITCACHE_H_
+
+#include <cstddef>
+#include <vector>
+#include "Rtypes.h"
+#include "TString.h"
+#include "KeyedRecordFile.h"
+
+class TTree;
+class SVFitObject;
+
+class SVFitCache {
+public:
+	SVFitCache();
+	virtual ~SVFitCache();
+
+	// map an existing cache file, false if it does not exist or was built from other input (signature)
+	bool Open(TString file, ULong64_t signature);
+	// build the cache file from tree (branches RunNumber, LumiNumber, EventNumber, svfit) and map it
+	bool Build(TString file, ULong64_t signature, TTree* tree);
+	void Close();
+
+	// fill obj with the stored result, false if the event is not in the cache
+	bool Get(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, SVFitObject& obj) const;
+
+	bool isOpen() const {return file_.isOpen();}
+	ULong64_t GetNEntries() const;
+
+	// 64 bit FNV-1a hash of a string, e.g. to build a signature from the input files and their versions
+	static ULong64_t Signature(const TString& s);
+
+	// plain-data form of an SVFitObject (also used to pass results between processes, see SVfitPool),
+	// starts with the fields of KeyedRecordFile::Key
+	struct Record {
+		UInt_t run;
+		UInt_t lumi;
+		UInt_t event;
+		UInt_t nTaus;
+		ULong64_t inputHash;
+		double mass, massUncert, pt, ptUncert, eta, etaUncert, phi, phiUncert;
+		double massLmax, ptLmax, etaLmax, phiLmax;
+		double fittedTaus[2][4];   // px, py, pz, E
+		double measuredTaus[2][4];
+		double fittedMET[3];
+		double measuredMET[3];
+		Int_t valid;
+		Int_t addLogM;
+		Int_t maxObjFunctionCalls;
+		Int_t metPower;
+		char fitMethod[16];
+		char tauCorr[64];
+		char muonCorr[64];
+		char elecCorr[64];
+		char metType[64];
+	};
+	static void ToRecord(const SVFitObject& obj, Record& r);
+	static void FromRecord(const Record& r, SVFitObject& obj);
+	// append all entries of tree (SVFitStorage format) in the order of the tree, returns their number
+	static Long64_t ReadTree(TTree* tree, std::vector<Record>& records);
+
+private:
+	KeyedRecordFile file_;
+};
+
+#endif /* SVFITCACHE_H_ */
@@ -0,0 +1,34 @@
+// Merges SVFit output files (MySVFIT*.root of the analysis jobs, outputs of SVfitFit.exe) into one
+// file without duplicates, sorted and indexed by event, see SVFitStorage::Compact
+//
+// Usage: SVFitCompact.exe <output.root> <input files>
+// Of results stored in several files the one of the last file is kept; the output can be used
+// as "InputFileSVFit<suffix>:" of the analysis.
+
+#include <cstdlib>
+#include <vector>
+
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TString.h"
+#include "SVFitStorage.h"
+
+int main(int argc, char* argv[]) {
+	Logger::Instance()->SetLevel(Logger::Info);
+	gROOT->SetBatch(kTRUE);
+
+	if (argc < 3) {
+		Logger(Logger::Fatal) << "Usage: SVFitCompact.exe <output.root> <input files>" << std::endl;
+		return 6;
+	}
+	TString output = argv[1];
+	std::vector<TString> inputs;
+	for (int i = 2; i < argc; i++) inputs.push_back(argv[i]);
+
+	// dictionary of SVFitObject
+	TString thelib = getenv("DATAFORMATS_LIB");
+	gSystem->Load(thelib.Data());
+
+	return SVFitStorage::Compact(inputs, output) ? 0 : 1;
+}
@@ -10,16 +10,31 @@
 #include "TDirectory.h"
 #include "TFile.h"
 #include "SVFitObject.h"
+#include "TROOT.h"
+#include "TKey.h"
+#include "TClass.h"
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 #include "SimpleFits/FitSoftware/interface/Logger.h"
-#include "TChainIndex.h"
-#include "TTreeIndex.h"
+
+namespace {
+// order of the compacted trees
+bool recordLess(const SVFitCache::Record& a, const SVFitCache::Record& b){
+	if (a.run != b.run) return a.run < b.run;
+	if (a.lumi != b.lumi) return a.lumi < b.lumi;
+	if (a.event != b.event) return a.event < b.event;
+	return a.inputHash < b.inputHash;
+}
+}
+
+std::map<SVFitStorage::ResultKey, SVFitObject> SVFitStorage::fittedInJob_;
+bool SVFitStorage::requestMode_ = false;
 
 SVFitStorage::SVFitStorage():
 	outfile_(0),
 	outtree_(0),
 	intree_(0),
-	index_(0),
 	treeName_("invalid"),
 	suffix_(""),
 	svfit_(0),
@@ -28,7 +43,8 @@ SVFitStorage::SVFitStorage():
 	b_EventNumber_(0),
 	b_svfit_(0),
 	isConfigured_(false),
-	intreeLoaded_(false){
+	intreeLoaded_(false),
+	nDuplicates_(0){
 
 	TString thelib= getenv ("DATAFORMATS_LIB");
 	gSystem->Load(thelib.Data());
@@ -59,6 +75,18 @@ SVFitStorage::~SVFitStorage(){
 			StoreFile(outfileName , storageFileName_);
 			Logger(Logger::Info) << outfileName.Data() << " saved to the grid " << storageFileName_.Data() << std::endl;
 		}
+
+		// list of fits needed (request mode)
+		if (requests_.isOpen()){
+			unsigned int nRequests = requests_.GetNRequests();
+			TString requestsFileLocal = "SVFitRequests" + suffix_ + TString::Itoa(instance,10) + ".bin";
+			requests_.Close();
+			Logger(Logger::Info) << nRequests << " SVFit fits for " << treeName_ << " listed in " << requestsFileLocal << std::endl;
+			if (nRequests > 0 && requestsFileName_ != ""){
+				StoreFile(requestsFileLocal, requestsFileName_);
+				Logger(Logger::Info) << requestsFileLocal << " saved to the grid " << requestsFileName_ << std::endl;
+			}
+		}
 	}
 	Logger(Logger::Debug) << "Properly destroyed." << std::endl;
 }
@@ -104,8 +132,15 @@ void SVFitStorage::Configure(TString datasetName, TString suffix /* ="" */){
 	outtree_->Branch("RunNumber", &RunNumber_);
 	outtree_->Branch("LumiNumber", &LumiNumber_);
 	outtree_->Branch("EventNumber", &EventNumber_);
+	outtree_->Branch("InputHash", &InputHash_);
 	outtree_->Branch("svfit", &svfit_);
 
+	// list of fits needed, to be fitted by SVfitFit.exe
+	if (requestMode_){
+		Par.GetString("OutputFileSVFitRequests" + suffix_ + ":", requestsFileName_, "");
+		requests_.Create("SVFitRequests" + suffix_ + TString::Itoa(instance,10) + ".bin", treeName_);
+	}
+
 	isConfigured_ = true;
 
 	// setup input tree
@@ -119,6 +154,34 @@ void SVFitStorage::LoadTree(){
 	}
 
 	TString key = "InputFileSVFit" + suffix_ + ":";
+
+	// the results are looked up in a memory-mapped cache identified by the tree name and the input files
+	// with their size and modification time (or checksum), i.e. it is rebuilt if an input file is replaced;
+	// if another job on this node has built it already, nothing has to be downloaded
+	Parameters Par; // assumes configured in Analysis.cxx
+	std::vector<TString> inputFiles;
+	TString cacheDir;
+	TString gridsite = "none";
+	Par.GetVectorString(key, inputFiles);
+	Par.GetString("SVFitCacheDir:", cacheDir, gSystem->TempDirectory());
+	Par.GetString("GRIDSite:", gridsite);
+	TString signatureString = treeName_;
+	bool versioned = true;
+	for (unsigned int i = 0; i < inputFiles.size(); i++) {
+		TString version = (gridsite != "none") ? SourceVersion(gridsite, inputFiles.at(i)) : "";
+		if (version == "") versioned = false;
+		signatureString += ":" + inputFiles.at(i) + "@" + version;
+	}
+	if (inputFiles.size() > 0 && !versioned)
+		Logger(Logger::Warning) << "Size and modification time of the SVFit input files are not available, the SVFit cache is rebuilt." << std::endl;
+	ULong64_t signature = SVFitCache::Signature(signatureString);
+	TString cacheFile = cacheDir + "/SVFitCache_" + TString::Format("%016llx", signature) + ".bin";
+	if (inputFiles.size() > 0 && versioned && cache_.Open(cacheFile, signature)) {
+		Logger(Logger::Info) << "Using SVFit cache " << cacheFile << " with " << cache_.GetNEntries() << " results for " << treeName_ << std::endl;
+		intreeLoaded_ = true;
+		return;
+	}
+
 	int nfiles = GetFile(key);
 	if (nfiles == 0) {
 		Logger(Logger::Warning) << "Key not found: " << key <<
@@ -146,22 +209,15 @@ void SVFitStorage::LoadTree(){
 		if (intree_->LoadTree(0) < 0)
 			Logger(Logger::Error) << "Input TChain was not loaded correctly." << std::endl;
 
-		//Set branches
-		intree_->SetBranchAddress("RunNumber", &RunNumber_, &b_RunNumber_);
-		intree_->SetBranchAddress("LumiNumber", &LumiNumber_, &b_LumiNumber_);
-		intree_->SetBranchAddress("EventNumber", &EventNumber_, &b_EventNumber_);
-		intree_->SetBranchAddress("svfit", &svfit_, &b_svfit_);
-
-		// Create and set index
-		Logger(Logger::Debug) << "Building the index ..." << std::endl;
-		index_ = new TTreeIndex(intree_,"(RunNumber<<13) + LumiNumber", "EventNumber");
-		intree_->SetTreeIndex(index_);
+		// read the input tree once into the cache
+		if (!cache_.Build(cacheFile, signature, intree_))
+			Logger(Logger::Error) << "SVFit cache " << cacheFile << " could not be built." << std::endl;
 
 		gDirectory = gdirectory_save;
 		gDirectory->cd();
 
 		Logger(Logger::Verbose) << "Input TTree " << treeName_ << " has been loaded." << std::endl;
-		intreeLoaded_ = true;
+		intreeLoaded_ = cache_.isOpen();
 	}
 }
 
@@ -194,6 +250,8 @@ void SVFitStorage::SaveTree(){
 		return;
 	}
 
+	if (nDuplicates_ > 0) Logger(Logger::Info) << nDuplicates_ << " results for " << treeName_ << " were saved before and have not been stored again." << std::endl;
+
 	//Save output
 	TDirectory *gdirectory_save = gDirectory;
 	outfile_->cd();
@@ -204,61 +262,154 @@ void SVFitStorage::SaveTree(){
 	Logger(Logger::Info) << "SVFit_Tree saved to " << outfile_->GetName() << std::endl;
 }
 
-void SVFitStorage::SaveEvent(Int_t RunNumber, Int_t LumiNumber, Int_t EventNumber, SVFitObject* svfit){
+void SVFitStorage::SaveEvent(Int_t RunNumber, Int_t LumiNumber, Int_t EventNumber, SVFitObject* svfit, ULong64_t inputHash /* =0 */){
 	if (!isConfigured_) {
 		Logger(Logger::Error) << "SVFitStorage must be configured before SaveTree can be called." << std::endl;
 		return;
 	}
 
+	// the same fit may be saved twice, e.g. if it was submitted again before its result arrived (SVfitPool)
+	ResultKey key = {(UInt_t) RunNumber, (UInt_t) LumiNumber, (UInt_t) EventNumber, inputHash};
+	if (!saved_.insert(key).second) {
+		Logger(Logger::Verbose) << "Result of run " << RunNumber << ", event " << EventNumber << " has been saved before." << std::endl;
+		nDuplicates_++;
+		return;
+	}
+
 	//Fill event
 	RunNumber_ = RunNumber;
 	LumiNumber_ = LumiNumber;
 	EventNumber_ = EventNumber;
-	svfit_ = svfit;
+	InputHash_ = inputHash;
+	// copy, svfit may be owned by the caller (e.g. a result from SVfitPool)
+	if (svfit != svfit_) *svfit_ = *svfit;
 	outtree_->Fill();
+
+	if (inputHash != 0) fittedInJob_[key] = *svfit;
 }
 
-SVFitObject* SVFitStorage::GetEvent(UInt_t RunNumber, UInt_t LumiNumber, UInt_t EventNumber){
+SVFitObject* SVFitStorage::GetEvent(UInt_t RunNumber, UInt_t LumiNumber, UInt_t EventNumber, ULong64_t inputHash /* =0 */){
 	if (!isConfigured_) {
 		Logger(Logger::Error) << "SVFitStorage must be configured before GetEvent can be called." << std::endl;
 		*svfit_ = SVFitObject(); // invalid object
 		return svfit_;
 	}
-	if (!intreeLoaded_) {
-		Logger(Logger::Verbose) << "No input tree loaded, thus GetEvent does not work." << std::endl;
-		*svfit_ = SVFitObject(); // invalid object
+	Logger(Logger::Debug) << "Try to access run " << RunNumber << ", lumi " << LumiNumber << ", Event " << EventNumber << ", input hash " << inputHash << std::endl;
+	if (intreeLoaded_ && cache_.Get(RunNumber, LumiNumber, EventNumber, inputHash, *svfit_))
 		return svfit_;
-	}
-	if ( RunNumber != 1) { // true for data, false for MC
-		if (RunNumber > 262143 || LumiNumber > 4095) {
-			Logger(Logger::Error) << "In Data RunNumber must be smaller than 262144 and LumiNumber smaller than 4096" <<
-					"\n\tTrying to access run " << RunNumber << " and lumi " << LumiNumber <<
-					"\n\tExpect undefined behavior!" << std::endl;
-			*svfit_ = SVFitObject(); // invalid object
+	if (inputHash != 0) {
+		ResultKey key = {RunNumber, LumiNumber, EventNumber, inputHash};
+		std::map<ResultKey, SVFitObject>::const_iterator it = fittedInJob_.find(key);
+		if (it != fittedInJob_.end()) {
+			*svfit_ = it->second;
 			return svfit_;
 		}
+		// results stored without input hash
+		if (intreeLoaded_ && cache_.Get(RunNumber, LumiNumber, EventNumber, 0, *svfit_))
+			return svfit_;
 	}
+	Logger(Logger::Debug) << "Event not available in input tree." << std::endl;
+	*svfit_ = SVFitObject(); // invalid object
+	return svfit_;
+}
 
-	//Get tree entry using index and then get svfit
-	Logger(Logger::Debug) << "Try to access run " << RunNumber << ", lumi " << LumiNumber << ", Event " << EventNumber <<
-			"\n\ti.e. major = " << ((RunNumber << 13) + LumiNumber) << ", minor = " << EventNumber << std::endl;
-	Long64_t local = index_->GetEntryNumberWithIndex((RunNumber << 13) + LumiNumber, EventNumber);
-
-	// make sure that entry exists, otherwise return invalid result
-	if (local < 0) {
-		Logger(Logger::Debug) << "Index " << local << " not available in input tree." << std::endl;
-		*svfit_ = SVFitObject(); // invalid object
-		return svfit_;
+void SVFitStorage::RequestEvent(UInt_t RunNumber, UInt_t LumiNumber, UInt_t EventNumber, ULong64_t inputHash, const SVfitProvider::Inputs& inputs){
+	if (!requests_.isOpen()) {
+		Logger(Logger::Error) << "SVFitStorage must be configured in request mode before RequestEvent can be called." << std::endl;
+		return;
 	}
-	else {
-		Logger(Logger::Debug) << "Accessing index " << local << std::endl;
-		intree_->GetEntry(local);
+	if (inputs.nLeptons == 0) {
+		Logger(Logger::Error) << "SVFit inputs of run " << RunNumber << ", event " << EventNumber << " unknown, can not be requested." << std::endl;
+		return;
 	}
+	requests_.Add(RunNumber, LumiNumber, EventNumber, inputHash, inputs);
+}
+
+bool SVFitStorage::Compact(const std::vector<TString>& inputFiles, TString outputFile){
+	TDirectory *gdirectory_save = gDirectory;
 
-	// check if correct event was loaded
-	if (RunNumber_ != RunNumber) {
-		Logger(Logger::Error) << "Event " << EventNumber << " was not loaded correctly."<< std::endl;
-		*svfit_ = SVFitObject(); // rather return invalid object than wrong one
+	// trees of all input files
+	std::vector<TString> treeNames;
+	for (unsigned int i = 0; i < inputFiles.size(); i++) {
+		TFile *f = TFile::Open(inputFiles.at(i), "READ");
+		if (!f || f->IsZombie()) {
+			Logger(Logger::Error) << "File " << inputFiles.at(i) << " does not exist or is corrupted." << std::endl;
+			delete f;
+			gDirectory = gdirectory_save;
+			return false;
+		}
+		TIter next(f->GetListOfKeys());
+		TKey *key;
+		while ( (key = (TKey*) next()) ) {
+			TClass *cl = gROOT->GetClass(key->GetClassName());
+			if (!cl || !cl->InheritsFrom(TTree::Class())) continue;
+			if (std::find(treeNames.begin(), treeNames.end(), TString(key->GetName())) == treeNames.end()) treeNames.push_back(key->GetName());
+		}
+		delete f;
 	}
-	return svfit_;
+
+	TFile *out = TFile::Open(outputFile, "RECREATE");
+	if (!out || out->IsZombie()) {
+		Logger(Logger::Error) << outputFile << " could not be created" << std::endl;
+		delete out;
+		gDirectory = gdirectory_save;
+		return false;
+	}
+	for (unsigned int t = 0; t < treeNames.size(); t++) {
+		const TString& treeName = treeNames.at(t);
+		// one tree at a time, as plain records
+		std::vector<SVFitCache::Record> records;
+		for (unsigned int i = 0; i < inputFiles.size(); i++) {
+			TFile *f = TFile::Open(inputFiles.at(i), "READ");
+			TTree *tree = f ? dynamic_cast<TTree*>(f->Get(treeName)) : 0;
+			if (tree) SVFitCache::ReadTree(tree, records);
+			delete f;
+		}
+		// stable: of equal keys the latest record is last
+		std::stable_sort(records.begin(), records.end(), recordLess);
+
+		out->cd();
+		UInt_t run, lumi, event;
+		ULong64_t inputHash;
+		SVFitObject *svfit = new SVFitObject();
+		TTree *tree = new TTree(treeName, treeName);
+		tree->Branch("RunNumber", &run);
+		tree->Branch("LumiNumber", &lumi);
+		tree->Branch("EventNumber", &event);
+		tree->Branch("InputHash", &inputHash);
+		tree->Branch("svfit", &svfit);
+		unsigned int nDuplicates = 0, nConflicts = 0;
+		for (unsigned int i = 0; i < records.size(); i++) {
+			const SVFitCache::Record& r = records.at(i);
+			if (i + 1 < records.size() && !recordLess(r, records.at(i + 1))) {
+				// replaced by the next one
+				nDuplicates++;
+				if (memcmp(&r, &records.at(i + 1), sizeof(SVFitCache::Record)) != 0) {
+					nConflicts++;
+					Logger(Logger::Verbose) << treeName << ": run " << r.run << ", event " << r.event << ", input hash " << r.inputHash
+							<< " stored with different results, mass " << r.mass << " is replaced by " << records.at(i + 1).mass << std::endl;
+				}
+				continue;
+			}
+			run = r.run;
+			lumi = r.lumi;
+			event = r.event;
+			inputHash = r.inputHash;
+			SVFitCache::FromRecord(r, *svfit);
+			tree->Fill();
+		}
+		tree->BuildIndex("RunNumber", "EventNumber");
+		tree->Write(treeName);
+		Logger(Logger::Info) << treeName << ": " << tree->GetEntries() << " results, " << nDuplicates << " duplicates removed" << std::endl;
+		if (nConflicts > 0)
+			Logger(Logger::Warning) << treeName << ": " << nConflicts << " duplicates had a different result, the latest one has been kept." << std::endl;
+		delete tree;
+		delete svfit;
+	}
+	out->Close();
+	delete out;
+	gDirectory = gdirectory_save;
+	gDirectory->cd();
+	Logger(Logger::Info) << "Compacted " << inputFiles.size() << " files with " << treeNames.size() << " trees into " << outputFile << std::endl;
+	return true;
 }
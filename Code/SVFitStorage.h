@@ -2,6 +2,8 @@
 #define SVFitStorage_h
 
 #include <vector>
+#include <map>
+#include <set>
 #include "TString.h"
 #include "TSystem.h"
 #include "TTree.h"
@@ -11,6 +13,8 @@
 #include "TChainIndex.h"
 #include "TFile.h"
 #include "SVFitObject.h"
+#include "SVFitCache.h"
+#include "SVfitRequestList.h"
 #include "DataStorage.h"
 #include "TBranch.h"
 
@@ -22,12 +26,27 @@ class SVFitStorage : public DataStorage {
   void Configure(TString datasetName, TString suffix = "");
 
   void SaveTree();
-  void SaveEvent(Int_t RunNumber, Int_t LumiNumber, Int_t EventNumber, SVFitObject* svfit);
+  // inputHash: SVfitProvider::get_inputHash() of the fit (0: inputs unknown)
+  void SaveEvent(Int_t RunNumber, Int_t LumiNumber, Int_t EventNumber, SVFitObject* svfit, ULong64_t inputHash = 0);
   // obtain SVFitObject from Tree. Make sure to test validity of object
-  SVFitObject* GetEvent(UInt_t RunNumber, UInt_t LumiNumber, UInt_t EventNumber);
+  // Results are matched by event and inputHash, so variations with unchanged SVfit inputs find the
+  // nominal result (also if it was fitted earlier in this job by another SVFitStorage instance).
+  // Stored results without input hash (old files) are matched by event only.
+  SVFitObject* GetEvent(UInt_t RunNumber, UInt_t LumiNumber, UInt_t EventNumber, ULong64_t inputHash = 0);
   
   bool isConfigured(){return isConfigured_;}
 
+  // pass one of the two-pass production ("SVfitMode: List"): results which are not stored are
+  // listed with RequestEvent instead of being fitted, see SVfitRequestList
+  static void SetRequestMode(bool requestMode){requestMode_ = requestMode;}
+  static bool isRequestMode(){return requestMode_;}
+  void RequestEvent(UInt_t RunNumber, UInt_t LumiNumber, UInt_t EventNumber, ULong64_t inputHash, const SVfitProvider::Inputs& inputs);
+
+  // merge SVFit output files (e.g. of many jobs) into outputFile: one tree per tree name, sorted by
+  // run, lumi, event and input hash and indexed by run and event. Of results stored more than once the
+  // latest is kept (order of inputFiles, then of the entries); differing duplicates are reported.
+  static bool Compact(const std::vector<TString>& inputFiles, TString outputFile);
+
  private:
   void LoadTree();
   bool isTreeInFile(TString fileName);
@@ -35,7 +54,9 @@ class SVFitStorage : public DataStorage {
   TFile *outfile_;
   TTree *outtree_;
   TChain *intree_;
-  TTreeIndex *index_;
+  SVFitCache cache_; // lookup of the input results, built once from intree_
+  SVfitRequestList requests_; // fits needed, in request mode
+  TString requestsFileName_;
   
   TString treeName_;
   TString suffix_; // optional identifier for modifications (e.g. systematics)
@@ -44,6 +65,7 @@ class SVFitStorage : public DataStorage {
   UInt_t RunNumber_;
   UInt_t LumiNumber_;
   UInt_t EventNumber_;
+  ULong64_t InputHash_;
   SVFitObject *svfit_;
 
   TBranch *b_RunNumber_;
@@ -53,5 +75,22 @@ class SVFitStorage : public DataStorage {
 
   bool isConfigured_;
   bool intreeLoaded_;
+
+  // results fitted in this process, shared by all instances
+  struct ResultKey {
+    UInt_t run, lumi, event;
+    ULong64_t inputHash;
+    bool operator<(const ResultKey& o) const {
+      if (inputHash != o.inputHash) return inputHash < o.inputHash;
+      if (event != o.event) return event < o.event;
+      if (run != o.run) return run < o.run;
+      return lumi < o.lumi;
+    }
+  };
+  static std::map<ResultKey, SVFitObject> fittedInJob_;
+  // results written by this instance, each result is stored only once
+  std::set<ResultKey> saved_;
+  unsigned int nDuplicates_;
+  static bool requestMode_;
 };
 #endif
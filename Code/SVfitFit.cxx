@@ -0,0 +1,151 @@
+// Standalone SVfit fitter, pass two of the two-pass SVfit production, see SVfitRequestList.h
+//
+// Usage: SVfitFit.exe [-j nWorkers] [-s shard/nShards] <output.root> <request lists>
+//   -j  number of worker processes (default 1: fit in this process)
+//   -s  fit only every nShards'th of the listed events, starting at shard (0 <= shard < nShards),
+//       e.g. to split the fits of one systematic over several jobs
+// All request lists have to belong to the same SVFitStorage tree (dataset and systematic).
+// The output file can be used as "InputFileSVFit<suffix>:" of the analysis. The cost of the fits
+// is written to <output>_statistics.root, see SVfitStatistics.h.
+
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <set>
+
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TString.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "SVFitObject.h"
+#include "SVfitPool.h"
+#include "SVfitRequestList.h"
+#include "SVfitStatistics.h"
+
+namespace {
+// writes the results in the format of SVFitStorage
+struct ResultTree {
+	TTree *tree;
+	UInt_t run, lumi, event;
+	ULong64_t inputHash;
+	SVFitObject *svfit;
+	unsigned int nFailed;
+};
+
+class TreeFiller : public SVfitPool::Consumer {
+public:
+	TreeFiller(ResultTree& out, const SVfitRequestList::Request& r):
+		out_(out), run_(r.run), lumi_(r.lumi), event_(r.event), inputHash_(r.inputHash) {}
+	virtual void Consume(const SVFitObject& result) {
+		if (!result.isValid()) {
+			Logger(Logger::Error) << "Unable to create a valid SVFit object for run " << run_ << ", event " << event_ << std::endl;
+			out_.nFailed++;
+			return;
+		}
+		out_.run = run_;
+		out_.lumi = lumi_;
+		out_.event = event_;
+		out_.inputHash = inputHash_;
+		*out_.svfit = result;
+		out_.tree->Fill();
+	}
+	// the hps decay mode is not part of the fit inputs
+	virtual void FitDone(const SVFitObject& result, const SVfitProvider::FitStats& stats) {
+		SVfitStatistics::Instance().AddFit(out_.tree->GetName(), -1, result, stats);
+	}
+private:
+	ResultTree& out_;
+	UInt_t run_, lumi_, event_;
+	ULong64_t inputHash_;
+};
+}
+
+int main(int argc, char* argv[]) {
+	Logger::Instance()->SetLevel(Logger::Info);
+	gROOT->SetBatch(kTRUE);
+
+	unsigned int nWorkers = 1, shard = 0, nShards = 1;
+	TString output;
+	std::vector<TString> inputs;
+	for (int i = 1; i < argc; i++) {
+		TString arg = argv[i];
+		if (arg == "-j" && i + 1 < argc) {
+			nWorkers = atoi(argv[++i]);
+		} else if (arg == "-s" && i + 1 < argc) {
+			if (sscanf(argv[++i], "%u/%u", &shard, &nShards) != 2) nShards = 0;
+		} else if (output == "") {
+			output = arg;
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+	if (output == "" || inputs.size() == 0 || nShards == 0 || shard >= nShards) {
+		Logger(Logger::Fatal) << "Usage: SVfitFit.exe [-j nWorkers] [-s shard/nShards] <output.root> <request lists>" << std::endl;
+		return 6;
+	}
+
+	// read the lists, the same fit may be listed by several jobs
+	TString treeName;
+	std::vector<SVfitRequestList::Request> requests;
+	for (unsigned int i = 0; i < inputs.size(); i++) {
+		TString name;
+		std::vector<SVfitRequestList::Request> r;
+		if (!SVfitRequestList::Read(inputs.at(i), name, r)) return 1;
+		if (treeName == "") treeName = name;
+		if (name != treeName) {
+			Logger(Logger::Fatal) << inputs.at(i) << " lists fits for " << name << ", not for " << treeName << std::endl;
+			return 6;
+		}
+		requests.insert(requests.end(), r.begin(), r.end());
+	}
+	std::vector<SVfitRequestList::Request> todo;
+	std::set<std::pair<std::pair<UInt_t, UInt_t>, std::pair<UInt_t, ULong64_t> > > listed;
+	for (unsigned int i = 0; i < requests.size(); i++) {
+		const SVfitRequestList::Request& r = requests.at(i);
+		if (!listed.insert(std::make_pair(std::make_pair(r.run, r.lumi), std::make_pair(r.event, r.inputHash))).second) continue;
+		if ((listed.size() - 1) % nShards == shard) todo.push_back(r);
+	}
+	Logger(Logger::Info) << "Fitting " << todo.size() << " of " << listed.size() << " events for " << treeName
+			<< " (shard " << shard << "/" << nShards << ") with " << nWorkers << " workers" << std::endl;
+
+	// dictionary of SVFitObject
+	TString thelib = getenv("DATAFORMATS_LIB");
+	gSystem->Load(thelib.Data());
+
+	TFile *file = TFile::Open(output, "RECREATE");
+	if (!file || file->IsZombie()) {
+		Logger(Logger::Fatal) << output << " could not be created" << std::endl;
+		return 1;
+	}
+	ResultTree out;
+	out.svfit = new SVFitObject();
+	out.nFailed = 0;
+	out.tree = new TTree(treeName, treeName);
+	out.tree->Branch("RunNumber", &out.run);
+	out.tree->Branch("LumiNumber", &out.lumi);
+	out.tree->Branch("EventNumber", &out.event);
+	out.tree->Branch("InputHash", &out.inputHash);
+	out.tree->Branch("svfit", &out.svfit);
+
+	SVfitPool& pool = SVfitPool::Instance();
+	pool.SetNWorkers(nWorkers > 1 ? nWorkers : 0);
+	for (unsigned int i = 0; i < todo.size(); i++) {
+		SVfitPool::Key key = {todo.at(i).run, todo.at(i).lumi, todo.at(i).event, todo.at(i).inputHash};
+		pool.Submit(todo.at(i).inputs, key, new TreeFiller(out, todo.at(i)));
+		if ((i + 1) % 1000 == 0) Logger(Logger::Info) << "Submitted " << i + 1 << " of " << todo.size() << " fits" << std::endl;
+	}
+	pool.Stop();
+	TString statFile = output;
+	statFile.ReplaceAll(".root", "");
+	SVfitStatistics::Instance().Write(statFile + "_statistics.root");
+
+	file->cd();
+	out.tree->Write(treeName);
+	Logger(Logger::Info) << "Stored " << out.tree->GetEntries() << " SVFit results in " << output << ", failed fits: " << out.nFailed << std::endl;
+	delete out.tree;
+	delete file;
+	delete out.svfit;
+	return out.nFailed > 0 ? 2 : 0;
+}
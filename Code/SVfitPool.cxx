@@ -0,0 +1,270 @@
+/*
+ * SVfitPool.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SVfitPool.h"
+#include "SVFitCache.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+SVfitPool& SVfitPool::Instance(){
+	static SVfitPool pool;
+	return pool;
+}
+
+SVfitPool::SVfitPool():
+	nWorkers(0)
+{
+}
+
+SVfitPool::~SVfitPool() {
+	Stop();
+}
+
+void SVfitPool::SetNWorkers(unsigned int n){
+	if(n == nWorkers) return;
+	Stop();
+	nWorkers = n;
+	if(nWorkers > 0) Logger(Logger::Info) << "SVfit fits are run in " << nWorkers << " worker processes" << std::endl;
+}
+
+void SVfitPool::StartWorkers(){
+	// a worker which died must not kill the job with SIGPIPE, write errors are handled
+	signal(SIGPIPE, SIG_IGN);
+	// buffered output would be written by every worker otherwise
+	fflush(stdout);
+	std::cout.flush();
+	for(unsigned int i=0; i<nWorkers; i++){
+		int req[2], res[2];
+		if(pipe(req) != 0) break;
+		if(pipe(res) != 0){
+			close(req[0]);
+			close(req[1]);
+			break;
+		}
+		pid_t pid = fork();
+		if(pid == 0){
+			close(req[1]);
+			close(res[0]);
+			for(unsigned int j=0; j<workers.size(); j++){
+				close(workers.at(j).request);
+				close(workers.at(j).response);
+			}
+			RunWorker(req[0], res[1]);
+		}
+		close(req[0]);
+		close(res[1]);
+		if(pid < 0){
+			close(req[1]);
+			close(res[0]);
+			break;
+		}
+		Worker w;
+		w.pid = pid;
+		w.request = req[1];
+		w.response = res[0];
+		workers.push_back(w);
+	}
+	if(workers.size() < nWorkers){
+		Logger(Logger::Warning) << "Could only start " << workers.size() << " of " << nWorkers << " SVfit workers." << std::endl;
+		nWorkers = workers.size();
+	}
+}
+
+// runs the fits of one worker until the request pipe is closed, does not return
+void SVfitPool::RunWorker(int request, int response){
+	SVfitProvider::Inputs in;
+	while(readFull(request, &in, sizeof(in))){
+		SVfitProvider svfProv(in);
+		SVFitObject obj = svfProv.runAndMakeObject();
+		SVFitCache::Record r;
+		memset(&r, 0, sizeof(r));
+		SVFitCache::ToRecord(obj, r);
+		if(!writeFull(response, &r, sizeof(r)) || !writeFull(response, &svfProv.get_fitStats(), sizeof(SVfitProvider::FitStats))) break;
+	}
+	fflush(stdout);
+	std::cout.flush();
+	_exit(0);
+}
+
+void SVfitPool::Submit(const SVfitProvider::Inputs& inputs, const Key& key, Consumer* consumer){
+	if(inputs.nLeptons == 0){
+		Logger(Logger::Error) << "SVfit inputs unknown, fit can not be submitted." << std::endl;
+		Deliver(SVFitObject(), consumer);
+		return;
+	}
+	// same fit already running: wait for its result
+	std::map<Key, Job*>::const_iterator it = running.find(key);
+	if(it != running.end()){
+		it->second->followers.push_back(AddJob(consumer, false, false));
+		Collect(false);
+		return;
+	}
+	if(nWorkers > 0 && workers.size() == 0) StartWorkers();
+
+	// least busy worker, wait for results if all are busy
+	Worker *w = NULL;
+	while(nWorkers > 0){
+		for(unsigned int i=0; i<workers.size(); i++){
+			if(workers.at(i).pid <= 0) continue;
+			if(w == NULL || workers.at(i).pending.size() < w->pending.size()) w = &workers.at(i);
+		}
+		if(w == NULL || w->pending.size() < MaxPending) break;
+		w = NULL;
+		Collect(true);
+	}
+	if(w == NULL){
+		// synchronous, or no worker left
+		SVfitProvider svfProv(inputs);
+		Job *job = AddJob(consumer, true, true);
+		job->result = svfProv.runAndMakeObject();
+		job->stats = svfProv.get_fitStats();
+		ConsumeDone();
+		return;
+	}
+
+	Job *job = AddJob(consumer, false, true);
+	job->key = key;
+	running[key] = job;
+	w->pending.push_back(job);
+	if(!writeFull(w->request, &inputs, sizeof(inputs))) FailWorker(*w);
+	Collect(false);
+}
+
+void SVfitPool::Deliver(const SVFitObject& result, Consumer* consumer){
+	AddJob(consumer, true, false)->result = result;
+	ConsumeDone();
+}
+
+SVfitPool::Job* SVfitPool::AddJob(Consumer* consumer, bool done, bool fitted){
+	Job *job = new Job();
+	job->consumer = consumer;
+	job->done = done;
+	job->fitted = fitted;
+	job->stats.realTime = 0;
+	job->stats.cpuTime = 0;
+	jobs.push_back(job);
+	return job;
+}
+
+void SVfitPool::Collect(bool block){
+	std::vector<pollfd> fds;
+	std::vector<Worker*> polled;
+	for(unsigned int i=0; i<workers.size(); i++){
+		if(workers.at(i).pid <= 0 || workers.at(i).pending.size() == 0) continue;
+		pollfd p;
+		p.fd = workers.at(i).response;
+		p.events = POLLIN;
+		p.revents = 0;
+		fds.push_back(p);
+		polled.push_back(&workers.at(i));
+	}
+	if(fds.size() > 0){
+		int n = poll(&fds.at(0), fds.size(), block ? -1 : 0);
+		if(n < 0 && errno != EINTR) Logger(Logger::Error) << "poll on SVfit workers failed: " << strerror(errno) << std::endl;
+		for(unsigned int i=0; n > 0 && i<fds.size(); i++){
+			if(fds.at(i).revents == 0) continue;
+			if(!ReadResult(*polled.at(i))) FailWorker(*polled.at(i));
+		}
+	}
+	ConsumeDone();
+}
+
+bool SVfitPool::ReadResult(Worker& w){
+	SVFitCache::Record r;
+	SVfitProvider::FitStats stats;
+	if(!readFull(w.response, &r, sizeof(r)) || !readFull(w.response, &stats, sizeof(stats))) return false;
+	Job *job = w.pending.front();
+	w.pending.pop_front();
+	SVFitCache::FromRecord(r, job->result);
+	job->stats = stats;
+	Finish(job);
+	return true;
+}
+
+// the job of a worker is done, also for the jobs waiting for the same fit
+void SVfitPool::Finish(Job* job){
+	job->done = true;
+	running.erase(job->key);
+	for(unsigned int i=0; i<job->followers.size(); i++){
+		job->followers.at(i)->result = job->result;
+		job->followers.at(i)->done = true;
+	}
+	job->followers.clear();
+}
+
+// the pending fits of a worker which died are consumed as invalid results
+void SVfitPool::FailWorker(Worker& w){
+	int status = 0;
+	close(w.request);
+	close(w.response);
+	waitpid(w.pid, &status, 0);
+	Logger(Logger::Error) << "SVfit worker " << w.pid << " failed, " << w.pending.size() << " fits are lost." << std::endl;
+	w.pid = -1;
+	for(unsigned int i=0; i<w.pending.size(); i++){
+		w.pending.at(i)->fitted = false;
+		Finish(w.pending.at(i));
+	}
+	w.pending.clear();
+}
+
+void SVfitPool::ConsumeDone(){
+	while(jobs.size() > 0 && jobs.front()->done){
+		Job *job = jobs.front();
+		jobs.pop_front();
+		if(job->fitted) job->consumer->FitDone(job->result, job->stats);
+		job->consumer->Consume(job->result);
+		delete job->consumer;
+		delete job;
+	}
+}
+
+// every job which is not done is pending on a running worker
+void SVfitPool::WaitAll(){
+	while(jobs.size() > 0) Collect(true);
+}
+
+void SVfitPool::Stop(){
+	WaitAll();
+	for(unsigned int i=0; i<workers.size(); i++){
+		if(workers.at(i).pid <= 0) continue;
+		close(workers.at(i).request); // worker exits at end of input
+		close(workers.at(i).response);
+		int status = 0;
+		waitpid(workers.at(i).pid, &status, 0);
+	}
+	workers.clear();
+}
+
+bool SVfitPool::readFull(int fd, void* buf, size_t size){
+	char *p = (char*) buf;
+	while(size > 0){
+		ssize_t n = read(fd, p, size);
+		if(n < 0 && errno == EINTR) continue;
+		if(n <= 0) return false;
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+bool SVfitPool::writeFull(int fd, const void* buf, size_t size){
+	const char *p = (const char*) buf;
+	while(size > 0){
+		ssize_t n = write(fd, p, size);
+		if(n < 0 && errno == EINTR) continue;
+		if(n <= 0) return false;
+		p += n;
+		size -= n;
+	}
+	return true;
+}
@@ -0,0 +1,116 @@
+/*
+ * SVfitPool.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Runs SVfit fits in forked worker processes while the event loop continues.
+ *
+ *      A fit is submitted with its plain inputs (SVfitProvider::Inputs) and a
+ *      Consumer, which is called with the result once it is available (e.g. to
+ *      fill the mass histograms of the event). Each worker runs its fits with
+ *      its own SVfitStandaloneAlgorithm; requests and results are passed
+ *      through pipes as plain data (SVFitCache::Record and the fit cost).
+ *      Consumers are always called in the order of submission, also for
+ *      results which were available immediately (Deliver), so histograms are
+ *      filled in the same order as in a synchronous job.
+ *      A fit submitted again (same run, lumi, event and input hash) while the
+ *      first one is still running is not run again, its consumer gets the
+ *      result of the running fit (without FitDone, the cost is counted once).
+ *      Processes are used instead of threads, as ROOT and SVfit are not
+ *      thread safe. Without workers (default, "SVfitWorkers:" in Input.txt)
+ *      each fit is run and consumed immediately.
+ *      WaitAll() has to be called before the consumed results are used.
+ */
+
+#ifndef SVFITPOOL_H_
+#define SVFITPOOL_H_
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <sys/types.h>
+#include "SVfitProvider.h"
+#include "DataFormats/SVFitObject.h"
+
+class SVfitPool {
+public:
+	class Consumer {
+	public:
+		virtual ~Consumer(){}
+		virtual void Consume(const SVFitObject& result) = 0;
+		// called before Consume if the fit was run (not for Deliver), e.g. to record its cost
+		virtual void FitDone(const SVFitObject& result, const SVfitProvider::FitStats& stats){}
+	};
+
+	// identifies a fit, see SVFitStorage
+	struct Key {
+		UInt_t run, lumi, event;
+		ULong64_t inputHash;
+		bool operator<(const Key& o) const {
+			if (inputHash != o.inputHash) return inputHash < o.inputHash;
+			if (event != o.event) return event < o.event;
+			if (run != o.run) return run < o.run;
+			return lumi < o.lumi;
+		}
+	};
+
+	static SVfitPool& Instance();
+	virtual ~SVfitPool();
+
+	// number of worker processes, 0: run the fits synchronously
+	void SetNWorkers(unsigned int n);
+	unsigned int GetNWorkers() const {return nWorkers;}
+	bool isAsync() const {return nWorkers > 0;}
+
+	// queue a fit, consumer is called with its result and deleted afterwards
+	void Submit(const SVfitProvider::Inputs& inputs, const Key& key, Consumer* consumer);
+	// queue an already known result (keeps the order with the submitted fits)
+	void Deliver(const SVFitObject& result, Consumer* consumer);
+	// consume the results which arrived, block: wait for at least one result
+	void Collect(bool block);
+	// wait for all fits and consume their results
+	void WaitAll();
+	// wait for all fits and stop the workers
+	void Stop();
+
+private:
+	SVfitPool();
+
+	struct Job {
+		Consumer *consumer;
+		bool done;
+		bool fitted;
+		SVFitObject result;
+		SVfitProvider::FitStats stats;
+		Key key;
+		std::vector<Job*> followers; // same fit, submitted while this one was running
+	};
+
+	struct Worker {
+		pid_t pid;
+		int request;  // write end
+		int response; // read end
+		std::deque<Job*> pending; // results arrive in the order of the requests
+	};
+
+	void StartWorkers();
+	void RunWorker(int request, int response);
+	bool ReadResult(Worker& w);
+	void FailWorker(Worker& w);
+	Job* AddJob(Consumer* consumer, bool done, bool fitted);
+	void Finish(Job* job);
+	void ConsumeDone();
+
+	static bool readFull(int fd, void* buf, size_t size);
+	static bool writeFull(int fd, const void* buf, size_t size);
+
+	unsigned int nWorkers;
+	std::vector<Worker> workers;
+	std::deque<Job*> jobs; // all jobs in the order of submission
+	std::map<Key, Job*> running; // jobs pending on a worker
+
+	// results a worker may have queued; keeps both pipes below their buffer size
+	static const unsigned int MaxPending = 16;
+};
+
+#endif /* SVFITPOOL_H_ */
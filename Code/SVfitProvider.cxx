@@ -7,9 +7,21 @@
 
 #include "Ntuple_Controller.h"
 #include "SVfitProvider.h"
+#include "FNVHash.h"
 #include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TStopwatch.h"
+#include <cstring>
 
+namespace {
+void copyString(char* dest, size_t size, const TString& s){
+	strncpy(dest, s.Data(), size - 1);
+	dest[size - 1] = '\0';
+}
+}
+
+// called by run(), so that providers which are only used for the input hash (cache lookup) do not allocate the algorithm
 void SVfitProvider::createSvFitAlgo() {
+	delete svFitAlgo_;
 	svFitAlgo_ = new SVfitStandaloneAlgorithm(inputTauLeptons_, inputMet_.ex(), inputMet_.ey(), inputMet_.significanceMatrix(), verbosity_);
 	svFitAlgo_->addLogM(addLogM_);
 	if (maxObjFunctionCalls_ >= 0) svFitAlgo_->maxObjFunctionCalls(maxObjFunctionCalls_);
@@ -23,6 +35,8 @@ SVfitProvider::SVfitProvider(Ntuple_Controller* const Ntp, objects::MET& met, TS
 		int verbosity/* =1 */, double scaleLep1 /* =1 */, double scaleLep2 /* =1 */){
 	ntp_ = Ntp;
 	inputMet_ = met;
+	leptonHash_ = FNVHash::Start;
+	memset(&plainInputs_, 0, sizeof(Inputs));
 
 	addMeasuredLepton(typeLep1, idxLep1, scaleLep1);
 	addMeasuredLepton(typeLep2, idxLep2, scaleLep2);
@@ -36,7 +50,10 @@ SVfitProvider::SVfitProvider(Ntuple_Controller* const Ntp, objects::MET& met, TS
 	maxObjFunctionCalls_ = -1;
 	metPower_ = -1;
 
-	createSvFitAlgo();
+	svFitAlgo_ = NULL;
+	isSetup_ = false;
+	fitStats_.realTime = 0;
+	fitStats_.cpuTime = 0;
 }
 
 // Constructor to be used in analysis:
@@ -45,6 +62,8 @@ SVfitProvider::SVfitProvider(Ntuple_Controller* const Ntp, objects::MET& met, TS
 		int verbosity/* =1 */, double scaleLep1 /* =1 */, double scaleLep2 /* =1 */){
 	ntp_ = Ntp;
 	inputMet_ = met;
+	leptonHash_ = FNVHash::Start;
+	memset(&plainInputs_, 0, sizeof(Inputs));
 
 	addMeasuredLepton(typeLep1, idxLep1, scaleLep1);
 	addFullReco3ProngTau(lvec3ProngTau);
@@ -58,8 +77,47 @@ SVfitProvider::SVfitProvider(Ntuple_Controller* const Ntp, objects::MET& met, TS
 	maxObjFunctionCalls_ = -1;
 	metPower_ = -1;
 
-	createSvFitAlgo();
+	svFitAlgo_ = NULL;
+	isSetup_ = false;
+	fitStats_.realTime = 0;
+	fitStats_.cpuTime = 0;
+}
+
+// Constructor from plain inputs
+SVfitProvider::SVfitProvider(const Inputs& inputs){
+	ntp_ = NULL;
+	leptonHash_ = FNVHash::Start;
+	memset(&plainInputs_, 0, sizeof(Inputs));
+	copyString(plainInputs_.tauCorr, sizeof(plainInputs_.tauCorr), inputs.tauCorr);
+	copyString(plainInputs_.muonCorr, sizeof(plainInputs_.muonCorr), inputs.muonCorr);
+	copyString(plainInputs_.elecCorr, sizeof(plainInputs_.elecCorr), inputs.elecCorr);
+
+	inputMet_.set_et(inputs.metEt);
+	inputMet_.set_phi(inputs.metPhi);
+	inputMet_.set_ex(inputs.metEx);
+	inputMet_.set_ey(inputs.metEy);
+	inputMet_.set_significance(inputs.metSignificance);
+	inputMet_.set_significanceXX(inputs.metSignificanceXX);
+	inputMet_.set_significanceXY(inputs.metSignificanceXY);
+	inputMet_.set_significanceYY(inputs.metSignificanceYY);
+	inputMet_.set_hasSignificance(inputs.metHasSignificance);
+	inputMet_.set_metType(inputs.metType);
+
+	for (unsigned int i = 0; i < inputs.nLeptons && i < 2; i++){
+		inputTauLeptons_.push_back(svFitStandalone::MeasuredTauLepton((svFitStandalone::kDecayType) inputs.decayType[i], inputs.pt[i], inputs.eta[i], inputs.phi[i], inputs.mass[i]));
+		recordLepton(inputs.decayType[i], inputs.pt[i], inputs.eta[i], inputs.phi[i], inputs.mass[i]);
+	}
+
+	verbosity_ = inputs.verbosity;
+	fitMethod_ = inputs.fitMethod;
+	addLogM_ = inputs.addLogM;
+	maxObjFunctionCalls_ = inputs.maxObjFunctionCalls;
+	metPower_ = inputs.metPower;
 
+	svFitAlgo_ = NULL;
+	isSetup_ = false;
+	fitStats_.realTime = 0;
+	fitStats_.cpuTime = 0;
 }
 
 SVfitProvider::~SVfitProvider() {
@@ -78,6 +136,8 @@ void SVfitProvider::run(){
 	if ( !isSetup_ )
 		createSvFitAlgo();
 
+	TStopwatch watch;
+	watch.Start();
 	if(fitMethod_ == "MarkovChain")
 		svFitAlgo_->integrateMarkovChain();
 	else if(fitMethod_ == "Vegas")
@@ -88,7 +148,9 @@ void SVfitProvider::run(){
 		Logger(Logger::Warning) << "Method " << fitMethod_ << " not available for SVfit. Using MarkovChain integration..." << std::endl;
 		svFitAlgo_->integrateMarkovChain();
 	}
-
+	watch.Stop();
+	fitStats_.realTime = watch.RealTime();
+	fitStats_.cpuTime = watch.CpuTime();
 }
 
 // constructor from SVfitStandaloneAlgorithm
@@ -117,9 +179,15 @@ SVFitObject SVfitProvider::makeObject(const SVfitStandaloneAlgorithm* svfitAlgo,
 	obj.fittedMET_ = svfitAlgo->fittedMET();
 	obj.measuredMET_ = svfitAlgo->measuredMET();
 
-	obj.tauCorr_ = ntp_->GetTauCorrections();
-	obj.muonCorr_= ntp_->GetMuonCorrections();
-	obj.elecCorr_= ntp_->GetElecCorrections();
+	if (ntp_) {
+		obj.tauCorr_ = ntp_->GetTauCorrections();
+		obj.muonCorr_= ntp_->GetMuonCorrections();
+		obj.elecCorr_= ntp_->GetElecCorrections();
+	} else {
+		obj.tauCorr_ = plainInputs_.tauCorr;
+		obj.muonCorr_= plainInputs_.muonCorr;
+		obj.elecCorr_= plainInputs_.elecCorr;
+	}
 	obj.metType_ = inputMet_.metType();
 	obj.addLogM_ = addLogM_;
 	obj.maxObjFunctionCalls_ = maxObjFunctionCalls_;
@@ -136,6 +204,71 @@ SVFitObject SVfitProvider::makeObject(const SVfitStandaloneAlgorithm* svfitAlgo,
 	return obj;
 }
 
+// 64 bit FNV-1a over the bytes of value
+void SVfitProvider::hashCombine(ULong64_t& h, double value){
+	h = FNVHash::Add(h, &value, sizeof(double));
+}
+
+void SVfitProvider::recordLepton(int decayType, double pt, double eta, double phi, double mass){
+	if (leptonHash_ == 0) return; // inputs unknown
+	unsigned int i = plainInputs_.nLeptons;
+	if (i < 2) {
+		plainInputs_.decayType[i] = decayType;
+		plainInputs_.pt[i] = pt;
+		plainInputs_.eta[i] = eta;
+		plainInputs_.phi[i] = phi;
+		plainInputs_.mass[i] = mass;
+	}
+	plainInputs_.nLeptons++;
+	hashCombine(leptonHash_, decayType);
+	hashCombine(leptonHash_, pt);
+	hashCombine(leptonHash_, eta);
+	hashCombine(leptonHash_, phi);
+	hashCombine(leptonHash_, mass);
+}
+
+ULong64_t SVfitProvider::get_inputHash() const{
+	if (leptonHash_ == 0) return 0;
+	ULong64_t h = leptonHash_;
+	hashCombine(h, inputMet_.ex());
+	hashCombine(h, inputMet_.ey());
+	TMatrixD cov = inputMet_.significanceMatrix();
+	for (int i = 0; i < cov.GetNrows(); i++){
+		for (int j = 0; j < cov.GetNcols(); j++) hashCombine(h, cov(i, j));
+	}
+	for (int i = 0; i < fitMethod_.Length(); i++) hashCombine(h, fitMethod_[i]);
+	hashCombine(h, addLogM_);
+	hashCombine(h, maxObjFunctionCalls_);
+	hashCombine(h, metPower_);
+	return h != 0 ? h : 1; // 0 is reserved for unknown inputs
+}
+
+SVfitProvider::Inputs SVfitProvider::get_inputs() const{
+	Inputs in = plainInputs_;
+	if (leptonHash_ == 0) in.nLeptons = 0; // leptons set directly, not known
+	in.metEt = inputMet_.et();
+	in.metPhi = inputMet_.phi();
+	in.metEx = inputMet_.ex();
+	in.metEy = inputMet_.ey();
+	in.metSignificance = inputMet_.significance();
+	in.metSignificanceXX = inputMet_.significanceXX();
+	in.metSignificanceXY = inputMet_.significanceXY();
+	in.metSignificanceYY = inputMet_.significanceYY();
+	in.metHasSignificance = inputMet_.hasSignificance();
+	copyString(in.metType, sizeof(in.metType), inputMet_.metType());
+	copyString(in.fitMethod, sizeof(in.fitMethod), fitMethod_);
+	in.verbosity = verbosity_;
+	in.addLogM = addLogM_;
+	in.maxObjFunctionCalls = maxObjFunctionCalls_;
+	in.metPower = metPower_;
+	if (ntp_) {
+		copyString(in.tauCorr, sizeof(in.tauCorr), ntp_->GetTauCorrections());
+		copyString(in.muonCorr, sizeof(in.muonCorr), ntp_->GetMuonCorrections());
+		copyString(in.elecCorr, sizeof(in.elecCorr), ntp_->GetElecCorrections());
+	}
+	return in;
+}
+
 // convert TLorentzVector into ROOT::Math::LorentzVector
 svFitStandalone::LorentzVector SVfitProvider::convert_p4Vect(const TLorentzVector& in){
 	return svFitStandalone::LorentzVector(in.X(), in.Y(), in.Z(), in.T());
@@ -143,15 +276,22 @@ svFitStandalone::LorentzVector SVfitProvider::convert_p4Vect(const TLorentzVecto
 
 void SVfitProvider::addMeasuredLepton(TString type, int index, double energyScale /* = 1 */){
 	svFitStandalone::MeasuredTauLepton lep;
+	TLorentzVector p4;
 	type.ToLower();
 	if (type == "mu"){
-		lep = svFitStandalone::MeasuredTauLepton(svFitStandalone::kTauToMuDecay, energyScale * ntp_->Muon_p4(index).Pt(), ntp_->Muon_p4(index).Eta(), ntp_->Muon_p4(index).Phi(), energyScale * ntp_->Muon_p4(index).M());
+		p4 = ntp_->Muon_p4(index);
+		lep = svFitStandalone::MeasuredTauLepton(svFitStandalone::kTauToMuDecay, energyScale * p4.Pt(), p4.Eta(), p4.Phi(), energyScale * p4.M());
+		recordLepton(svFitStandalone::kTauToMuDecay, energyScale * p4.Pt(), p4.Eta(), p4.Phi(), energyScale * p4.M());
 	}
 	else if (type == "ele"){
-		lep = svFitStandalone::MeasuredTauLepton(svFitStandalone::kTauToElecDecay, energyScale * ntp_->Electron_p4(index).Pt(), ntp_->Electron_p4(index).Eta(), ntp_->Electron_p4(index).Phi(), energyScale * ntp_->Electron_p4(index).M());
+		p4 = ntp_->Electron_p4(index);
+		lep = svFitStandalone::MeasuredTauLepton(svFitStandalone::kTauToElecDecay, energyScale * p4.Pt(), p4.Eta(), p4.Phi(), energyScale * p4.M());
+		recordLepton(svFitStandalone::kTauToElecDecay, energyScale * p4.Pt(), p4.Eta(), p4.Phi(), energyScale * p4.M());
 	}
 	else if (type == "tau"){
-		lep = svFitStandalone::MeasuredTauLepton(svFitStandalone::kTauToHadDecay, energyScale * ntp_->PFTau_p4(index).Pt(), ntp_->PFTau_p4(index).Eta(), ntp_->PFTau_p4(index).Phi(), energyScale * ntp_->PFTau_p4(index).M());
+		p4 = ntp_->PFTau_p4(index);
+		lep = svFitStandalone::MeasuredTauLepton(svFitStandalone::kTauToHadDecay, energyScale * p4.Pt(), p4.Eta(), p4.Phi(), energyScale * p4.M());
+		recordLepton(svFitStandalone::kTauToHadDecay, energyScale * p4.Pt(), p4.Eta(), p4.Phi(), energyScale * p4.M());
 	}
 	else
 		Logger(Logger::Error) << "Object type " << type << " not implemented in SVfitProvider." << std::endl;
@@ -162,6 +302,7 @@ void SVfitProvider::addMeasuredLepton(TString type, int index, double energyScal
 
 void SVfitProvider::addFullReco3ProngTau(TLorentzVector lv){
 	svFitStandalone::MeasuredTauLepton lep(svFitStandalone::kPrompt, lv.Pt(), lv.Eta(), lv.Phi(), lv.M());
+	recordLepton(svFitStandalone::kPrompt, lv.Pt(), lv.Eta(), lv.Phi(), lv.M());
 	inputTauLeptons_.push_back(lep);
 	isSetup_ = false;
 }
@@ -20,6 +20,23 @@ class Ntuple_Controller;
 
 class SVfitProvider {
 public:
+	// plain-data copy of all inputs of a fit, e.g. to run it in another process (see SVfitPool)
+	struct Inputs {
+		unsigned int nLeptons;
+		int decayType[2];
+		double pt[2], eta[2], phi[2], mass[2];
+		float metEt, metPhi, metEx, metEy;
+		float metSignificance, metSignificanceXX, metSignificanceXY, metSignificanceYY;
+		int metHasSignificance;
+		char metType[64];
+		char fitMethod[16];
+		int verbosity;
+		int addLogM;
+		int maxObjFunctionCalls;
+		float metPower;
+		char tauCorr[64], muonCorr[64], elecCorr[64];
+	};
+
 	// Constructor to be used in analysis:
 	// Use default CMS leptons as input (electron, muon, hadronic tau)
 	SVfitProvider(Ntuple_Controller* const Ntp, objects::MET& met, TString typeLep1, int idxLep1, TString typeLep2, int idxLep2,
@@ -30,6 +47,9 @@ public:
 	SVfitProvider(Ntuple_Controller* const Ntp, objects::MET& met, TString typeLep1, int idxLep1, TLorentzVector lvec3ProngTau,
 			int verbosity/* =1 */, double scaleLep1 /* =1 */, double scaleLep2 /* =1 */);
 
+	// Constructor from plain inputs (obtained with get_inputs), no access to the ntuple needed
+	explicit SVfitProvider(const Inputs& inputs);
+
 	virtual ~SVfitProvider();
 
 	// run SVfit algorithm and create  SVfitObject
@@ -52,7 +72,7 @@ public:
 	void set_inputMet(const objects::MET& inputMet) {inputMet_ = inputMet; isSetup_ = false;}
 
 	const std::vector<svFitStandalone::MeasuredTauLepton>& get_inputTauLeptons() const {return inputTauLeptons_;}
-	void set_inputTauLeptons(const std::vector<svFitStandalone::MeasuredTauLepton>& inputTauLeptons) {inputTauLeptons_ = inputTauLeptons; isSetup_ = false;}
+	void set_inputTauLeptons(const std::vector<svFitStandalone::MeasuredTauLepton>& inputTauLeptons) {inputTauLeptons_ = inputTauLeptons; leptonHash_ = 0; isSetup_ = false;}
 
 	int get_verbosity() const {return verbosity_;}
 	void set_verbosity(int verbosity) {this->verbosity_ = verbosity;}
@@ -69,14 +89,31 @@ public:
 	float get_metPower() const {return metPower_;}
 	void set_metPower(float metPower) {metPower_ = metPower; isSetup_ = false;}
 
-	// access to SVfit object which holds the result
+	// cost of the last run() (the integrators do not report the number of evaluated points)
+	struct FitStats {
+		double realTime; // s
+		double cpuTime;  // s
+	};
+	const FitStats& get_fitStats() const {return fitStats_;}
+
+	// access to SVfit object which holds the result (NULL before run())
 	const SVfitStandaloneAlgorithm* result() const {return svFitAlgo_;}
 
+	// hash of everything the fit result depends on: visible 4-vectors and decay types of the
+	// leptons, MET vector and covariance, and the SVfit configuration.
+	// Used as cache key, so that variations which do not change the inputs reuse the nominal fit.
+	// 0 if the leptons were set with set_inputTauLeptons (unknown inputs).
+	ULong64_t get_inputHash() const;
+	// inputs of the fit, only complete if the leptons were not set with set_inputTauLeptons
+	Inputs get_inputs() const;
+
 private:
 	// input information
 	Ntuple_Controller* ntp_;
 	objects::MET inputMet_;
 	std::vector<svFitStandalone::MeasuredTauLepton> inputTauLeptons_;
+	ULong64_t leptonHash_; // hash of the leptons added with addMeasuredLepton/addFullReco3ProngTau
+	Inputs plainInputs_;   // leptons added with addMeasuredLepton/addFullReco3ProngTau and corrections
 	int verbosity_;
 	TString fitMethod_;
 	// SVfit configuration
@@ -88,10 +125,13 @@ private:
 
 	// output information
 	SVfitStandaloneAlgorithm* svFitAlgo_;
+	FitStats fitStats_;
 
 	void addMeasuredLepton(TString type, int index, double energyScale = 1);
 	void addFullReco3ProngTau(TLorentzVector lv);
 	void createSvFitAlgo();
+	void recordLepton(int decayType, double pt, double eta, double phi, double mass);
+	static void hashCombine(ULong64_t& h, double value);
 };
 
 #endif /* SVFITPROVIDER_H_ */
@@ -0,0 +1,91 @@
+/*
+ * SVfitRequestList.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SVfitRequestList.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include <cstring>
+
+namespace {
+const char ListMagic[8] = {'S', 'V', 'F', 'R', 'E', 'Q', 'S', 'T'};
+const UInt_t ListVersion = 1;
+}
+
+SVfitRequestList::SVfitRequestList():
+	file_(NULL),
+	nRequests_(0)
+{
+}
+
+SVfitRequestList::~SVfitRequestList() {
+	Close();
+}
+
+bool SVfitRequestList::Create(TString file, TString treeName){
+	Close();
+	Header h;
+	memset(&h, 0, sizeof(Header));
+	memcpy(h.magic, ListMagic, sizeof(ListMagic));
+	h.version = ListVersion;
+	h.recordSize = sizeof(Request);
+	strncpy(h.treeName, treeName.Data(), sizeof(h.treeName) - 1);
+	file_ = fopen(file.Data(), "wb");
+	if(file_ == NULL || fwrite(&h, sizeof(Header), 1, file_) != 1){
+		Logger(Logger::Error) << "Could not create SVfit request list " << file << std::endl;
+		Close();
+		return false;
+	}
+	fileName_ = file;
+	nRequests_ = 0;
+	listed_.clear();
+	return true;
+}
+
+void SVfitRequestList::Add(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, const SVfitProvider::Inputs& inputs){
+	if(file_ == NULL) return;
+	Key key = {run, lumi, event, inputHash};
+	if(!listed_.insert(key).second) return;
+	Request r;
+	memset(&r, 0, sizeof(Request));
+	r.run = run;
+	r.lumi = lumi;
+	r.event = event;
+	r.inputHash = inputHash;
+	r.inputs = inputs;
+	if(fwrite(&r, sizeof(Request), 1, file_) != 1){
+		Logger(Logger::Error) << "Could not write to SVfit request list " << fileName_ << std::endl;
+		return;
+	}
+	nRequests_++;
+}
+
+void SVfitRequestList::Close(){
+	if(file_ == NULL) return;
+	if(fclose(file_) != 0) Logger(Logger::Error) << "Could not write SVfit request list " << fileName_ << std::endl;
+	file_ = NULL;
+}
+
+bool SVfitRequestList::Read(TString file, TString& treeName, std::vector<Request>& requests){
+	FILE *f = fopen(file.Data(), "rb");
+	if(f == NULL){
+		Logger(Logger::Error) << "SVfit request list " << file << " does not exist." << std::endl;
+		return false;
+	}
+	Header h;
+	if(fread(&h, sizeof(Header), 1, f) != 1 || memcmp(h.magic, ListMagic, sizeof(ListMagic)) != 0
+			|| h.version != ListVersion || h.recordSize != sizeof(Request)){
+		Logger(Logger::Error) << file << " is not an SVfit request list of this version." << std::endl;
+		fclose(f);
+		return false;
+	}
+	h.treeName[sizeof(h.treeName) - 1] = '\0';
+	treeName = h.treeName;
+	Request r;
+	while(fread(&r, sizeof(Request), 1, f) == 1) requests.push_back(r);
+	bool ok = !ferror(f);
+	fclose(f);
+	if(!ok) Logger(Logger::Error) << "Could not read SVfit request list " << file << std::endl;
+	return ok;
+}
@@ -0,0 +1,81 @@
+/*
+ * SVfitRequestList.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      List of SVfit fits which are needed but not stored yet, for the
+ *      two-pass SVfit production.
+ *
+ *      Pass one runs the analysis with "SVfitMode: List": SVFitStorage does
+ *      not fit missing results but adds them to one list per systematic
+ *      (suffix). Each entry holds the complete plain fit inputs
+ *      (SVfitProvider::Inputs), so pass two (SVfitFit.exe) does not need the
+ *      ntuples at all. It fits the listed events in parallel and writes
+ *      files in the SVFitStorage format, which are used as
+ *      "InputFileSVFit<suffix>:" in the final analysis run.
+ *
+ *      File layout: Header | Request requests[]
+ */
+
+#ifndef SVFITREQUESTLIST_H_
+#define SVFITREQUESTLIST_H_
+
+#include <cstdio>
+#include <set>
+#include <vector>
+#include "Rtypes.h"
+#include "TString.h"
+#include "SVfitProvider.h"
+
+class SVfitRequestList {
+public:
+	struct Request {
+		UInt_t run;
+		UInt_t lumi;
+		UInt_t event;
+		UInt_t reserved;
+		ULong64_t inputHash;
+		SVfitProvider::Inputs inputs;
+	};
+
+	SVfitRequestList();
+	virtual ~SVfitRequestList();
+
+	// start a new list for the results stored in tree treeName
+	bool Create(TString file, TString treeName);
+	// add a fit, the same fit is listed only once
+	void Add(UInt_t run, UInt_t lumi, UInt_t event, ULong64_t inputHash, const SVfitProvider::Inputs& inputs);
+	void Close();
+
+	bool isOpen() const {return file_ != NULL;}
+	unsigned int GetNRequests() const {return nRequests_;}
+
+	// read a list written with Create/Add, false if it is missing or corrupted
+	static bool Read(TString file, TString& treeName, std::vector<Request>& requests);
+
+private:
+	struct Header {
+		char magic[8];
+		UInt_t version;
+		UInt_t recordSize;
+		char treeName[256];
+	};
+
+	struct Key {
+		UInt_t run, lumi, event;
+		ULong64_t inputHash;
+		bool operator<(const Key& o) const {
+			if (inputHash != o.inputHash) return inputHash < o.inputHash;
+			if (event != o.event) return event < o.event;
+			if (run != o.run) return run < o.run;
+			return lumi < o.lumi;
+		}
+	};
+
+	FILE *file_;
+	TString fileName_;
+	unsigned int nRequests_;
+	std::set<Key> listed_;
+};
+
+#endif /* SVFITREQUESTLIST_H_ */
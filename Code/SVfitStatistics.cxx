@@ -0,0 +1,129 @@
+/*
+ * SVfitStatistics.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SVfitStatistics.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include "TFile.h"
+#include "TDirectory.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+// log binning of the fit time, 1 ms to 100 s
+const int NTimeBins = 50;
+std::vector<double> timeBins(){
+	std::vector<double> b;
+	for(int i=0; i<=NTimeBins; i++) b.push_back(1e-3 * pow(10., 5. * i / NTimeBins));
+	return b;
+}
+
+TH1D* book(const TString& name, const TString& title, int nBins, double min, double max){
+	TH1D *h = new TH1D(name, title, nBins, min, max);
+	h->SetDirectory(0);
+	return h;
+}
+
+bool moreTime(const std::pair<double, TString>& a, const std::pair<double, TString>& b){
+	return a.first > b.first;
+}
+}
+
+SVfitStatistics& SVfitStatistics::Instance(){
+	static SVfitStatistics stat;
+	return stat;
+}
+
+SVfitStatistics::SVfitStatistics():
+	category_("unknown"),
+	nFits_(0)
+{
+}
+
+// the histograms are not deleted: the instance is destroyed at program exit, possibly after ROOT
+SVfitStatistics::~SVfitStatistics() {
+}
+
+SVfitStatistics::Entry& SVfitStatistics::GetEntry(const TString& category, int decayMode, const TString& fitMethod){
+	TString key = category + "_" + fitMethod + "_DM";
+	if(decayMode >= 0) key += decayMode;
+	else key += "Unknown";
+	std::map<TString, Entry>::iterator it = entries_.find(key);
+	if(it != entries_.end()) return it->second;
+
+	Entry e;
+	e.nFits = 0;
+	e.totalRealTime = 0;
+	e.totalCpuTime = 0;
+	std::vector<double> tb = timeBins();
+	e.realTime = book("SVfitRealTime_" + key, "SVfit real time " + key + ";t_{real} [s];fits", NTimeBins, 0, 1);
+	e.realTime->SetBins(NTimeBins, &tb.at(0));
+	e.cpuTime = book("SVfitCpuTime_" + key, "SVfit CPU time " + key + ";t_{CPU} [s];fits", NTimeBins, 0, 1);
+	e.cpuTime->SetBins(NTimeBins, &tb.at(0));
+	e.status = book("SVfitStatus_" + key, "SVfit status " + key + ";;fits", NStatus, -0.5, NStatus - 0.5);
+	e.status->GetXaxis()->SetBinLabel(Converged + 1, "converged");
+	e.status->GetXaxis()->SetBinLabel(NotConverged + 1, "not converged");
+	e.status->GetXaxis()->SetBinLabel(RerunSame + 1, "rerun same");
+	e.status->GetXaxis()->SetBinLabel(RerunDifferent + 1, "rerun different");
+	e.relMassUncert = book("SVfitRelMassUncert_" + key, "SVfit relative mass uncertainty " + key + ";#sigma_{m}/m;fits", 50, 0, 1);
+	entries_[key] = e;
+	return entries_[key];
+}
+
+void SVfitStatistics::AddFit(const TString& category, int decayMode, const SVFitObject& result, const SVfitProvider::FitStats& stats){
+	Entry& e = GetEntry(category, decayMode, result.get_fitMethod());
+	e.realTime->Fill(stats.realTime);
+	e.cpuTime->Fill(stats.cpuTime);
+	e.nFits++;
+	e.totalRealTime += stats.realTime;
+	e.totalCpuTime += stats.cpuTime;
+	e.status->Fill(result.isValid() ? Converged : NotConverged);
+	if(result.isValid() && result.get_mass() > 0) e.relMassUncert->Fill(result.get_massUncert() / result.get_mass());
+	nFits_++;
+}
+
+void SVfitStatistics::AddRerun(const TString& category, int decayMode, const TString& fitMethod, bool same){
+	GetEntry(category, decayMode, fitMethod).status->Fill(same ? RerunSame : RerunDifferent);
+}
+
+void SVfitStatistics::Write(TString file){
+	if(nFits_ == 0) return;
+
+	// summary, most expensive first
+	std::vector<std::pair<double, TString> > order;
+	for(std::map<TString, Entry>::iterator it = entries_.begin(); it != entries_.end(); ++it){
+		if(it->second.nFits > 0) order.push_back(std::make_pair(it->second.totalRealTime, it->first)); // not only reruns
+	}
+	std::sort(order.begin(), order.end(), moreTime);
+	Logger(Logger::Info) << "SVfit cost of " << nFits_ << " fits (category_method_decaymode: fits, total/mean real time, mean CPU time, converged, mean rel. mass uncertainty):" << std::endl;
+	for(unsigned int i=0; i<order.size(); i++){
+		const Entry& e = entries_[order.at(i).second];
+		Logger(Logger::Info) << "  " << order.at(i).second << ": " << e.nFits << ", "
+				<< e.totalRealTime << " s / " << e.totalRealTime / e.nFits << " s, " << e.totalCpuTime / e.nFits << " s, "
+				<< 100. * e.status->GetBinContent(Converged + 1) / e.nFits << "%, " << e.relMassUncert->GetMean()
+				<< " (reruns: " << e.status->GetBinContent(RerunSame + 1) << " same, " << e.status->GetBinContent(RerunDifferent + 1) << " different)" << std::endl;
+	}
+
+	TDirectory *gdirectory_save = gDirectory;
+	TFile *f = TFile::Open(file, "RECREATE");
+	if(f == NULL || f->IsZombie()){
+		Logger(Logger::Error) << "SVfit statistics could not be written to " << file << std::endl;
+		delete f;
+		gDirectory = gdirectory_save;
+		return;
+	}
+	f->cd();
+	for(std::map<TString, Entry>::iterator it = entries_.begin(); it != entries_.end(); ++it){
+		it->second.realTime->Write();
+		it->second.cpuTime->Write();
+		it->second.status->Write();
+		it->second.relMassUncert->Write();
+	}
+	f->Close();
+	delete f;
+	gDirectory = gdirectory_save;
+	Logger(Logger::Info) << "SVfit statistics written to " << file << std::endl;
+}
@@ -0,0 +1,64 @@
+/*
+ * SVfitStatistics.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Cost and convergence of the SVfit fits run in a job.
+ *
+ *      Each fit which is actually run (not read from SVFitStorage) is recorded
+ *      with its real and CPU time, whether it converged (valid result) and the
+ *      relative mass uncertainty, separately for each category (the selection
+ *      which requested it, see SetCategory), fit method and tau decay mode.
+ *      Reruns triggered by rerunEvery are counted with the comparison result.
+ *      Write() stores the histograms (SVfit<Quantity>_<category>_<method>_DM<mode>)
+ *      and prints a summary table, to find the categories which dominate the
+ *      SVfit time and to compare fit methods.
+ */
+
+#ifndef SVFITSTATISTICS_H_
+#define SVFITSTATISTICS_H_
+
+#include <map>
+#include "TString.h"
+#include "TH1D.h"
+#include "SVfitProvider.h"
+#include "DataFormats/SVFitObject.h"
+
+class SVfitStatistics {
+public:
+	enum Status {Converged = 0, NotConverged, RerunSame, RerunDifferent, NStatus};
+
+	static SVfitStatistics& Instance();
+	virtual ~SVfitStatistics();
+
+	// category of the fits requested from now on, e.g. the name of the running selection
+	void SetCategory(TString category){category_ = category;}
+	const TString& GetCategory() const {return category_;}
+
+	// decayMode: hps decay mode of the tau, -1 if unknown
+	void AddFit(const TString& category, int decayMode, const SVFitObject& result, const SVfitProvider::FitStats& stats);
+	void AddRerun(const TString& category, int decayMode, const TString& fitMethod, bool same);
+
+	unsigned int GetNFits() const {return nFits_;}
+	// write the histograms to file and print the summary, nothing is done without recorded fits
+	void Write(TString file);
+
+private:
+	SVfitStatistics();
+
+	struct Entry {
+		TH1D *realTime;
+		TH1D *cpuTime;
+		TH1D *status;
+		TH1D *relMassUncert;
+		unsigned int nFits;
+		double totalRealTime, totalCpuTime; // also of fits outside the histogram range
+	};
+	Entry& GetEntry(const TString& category, int decayMode, const TString& fitMethod);
+
+	TString category_;
+	std::map<TString, Entry> entries_;
+	unsigned int nFits_;
+};
+
+#endif /* SVFITSTATISTICS_H_ */
@@ -3,7 +3,13 @@
 
 #include "Tables.h"
 #include "Plots.h"
+#include "PlotRenderer.h"
 #include "SkimConfig.h"
+#include "HistoMerger.h"
+#include "TSystem.h"
+#include "TKey.h"
+#include "TTree.h"
+#include <cstring>
 #include <cstdlib>
 #include <map>
 #include <algorithm>
@@ -19,6 +25,7 @@ Selection::Selection(TString Name_, TString id_) :
 }
 
 Selection::~Selection() {
+	HistoConfig::RemoveTypeListener(this);
 	//Check that the correct number of events are run over
 	//SkimConfig SC;
 	//SC.CheckNEvents(types,nevents_noweight_default);
@@ -45,6 +52,7 @@ void Selection::ConfigureHistograms() {
 			//Npassed_noweight.at(j).Sumw2();
 			//Npassed.at(j).Sumw2();
 		}
+		HistoConfig::RegisterTypeListener(this);
 		Logger(Logger::Debug) << "Finished" << std::endl;
 	}
 }
@@ -53,86 +61,147 @@ void Selection::LoadResults(std::vector<TString> files) {
 	if (!isStored) {
 		ConfigureHistograms();
 	}
-	for (unsigned int f = 0; f < files.size(); f++) {
-		TString file = files.at(f);
-		if (!file.Contains(".root")) {
-			vector<TString> filelist;
-			string dir = file.Data();
-			DIR *dp;
-			struct dirent *dirp;
-			if ((dp = opendir(dir.c_str())) == NULL) {
-				Logger(Logger::Error) << "error number " << errno << " opening " << dir << endl;
-			} else {
-				while ((dirp = readdir(dp)) != NULL) {
-					filelist.push_back(string(dirp->d_name));
-				}
-				closedir(dp);
+	std::vector<TString> inputs = HistoMerger::ResolveFiles(files, Get_Name() + ".root");
+	std::vector<TString> readable;
+	for (unsigned int f = 0; f < inputs.size(); f++) {
+		if (inputs.at(f).Contains("root")) {
+			readable.push_back(inputs.at(f));
+		} else {
+			NBadFiles++;
+			Logger(Logger::Warning) << "File missing in: " << inputs.at(f) << std::endl;
+			ListofBadFiles.push_back(inputs.at(f));
+		}
+	}
+	if (readable.size() > 1) {
+		// combine the job outputs first (see HistoMerger, large 2D/3D histograms are merged sparse),
+		// then add the single merged file
+		TString merged;
+		unsigned int nGood;
+		std::vector<TString> bad;
+		if (HistoMerger::MergeCached(Get_Name(), readable, merged, nGood, bad) && loadFile(merged)) {
+			NGoodFiles += nGood;
+			NBadFiles += bad.size();
+			ListofBadFiles.insert(ListofBadFiles.end(), bad.begin(), bad.end());
+			readable.clear();
+		} else {
+			Logger(Logger::Warning) << "Merging of " << readable.size() << " files failed, reading them one by one." << std::endl;
+		}
+	}
+	for (unsigned int f = 0; f < readable.size(); f++) {
+		if (loadFile(readable.at(f))) {
+			NGoodFiles++;
+		} else {
+			NBadFiles++;
+			Logger(Logger::Warning) << readable.at(f) << " NOT OPENED" << std::endl;
+			ListofBadFiles.push_back(readable.at(f));
+		}
+	}
+	// local jobs evaluate systematics and make plots: bring all types to their final binning
+	if (runtype != GRID) {
+		densifySparse();
+		materializeAllTypes();
+	}
+}
+
+// add the histograms stored in file, false if the file could not be opened
+bool Selection::loadFile(TString file) {
+	TFile *f = TFile::Open(file, "READ");
+	if (f == NULL)
+		return false;
+	if (!f->IsOpen()) {
+		delete f;
+		return false;
+	}
+	Logger(Logger::Verbose) << "Selection::LoadResults " << file << std::endl;
+	TString hname;
+	if (sparseExtradist2d.size() != Extradist2d.size())
+		sparseExtradist2d.resize(Extradist2d.size());
+	if (sparseExtradist3d.size() != Extradist3d.size())
+		sparseExtradist3d.resize(Extradist3d.size());
+	for (unsigned int i = 0; i < Nminus1.size(); i++) {
+		for (unsigned int j = 0; j < Nminus1.at(i).size(); j++) {
+			addFromFile(Nminus1.at(i).at(j), f);
+			addFromFile(Nminus0.at(i).at(j), f);
+			if (distindx.at(i)) {
+				addFromFile(Nminus1dist.at(i).at(j), f);
+				addFromFile(Accumdist.at(i).at(j), f);
 			}
-			TString ID = Get_Name() + ".root";
-			for (unsigned int i = 0; i < filelist.size(); i++) {
-				if (filelist.at(i).Contains(ID)) {
-					file += filelist.at(i);
-					break;
+			if (i == 0) {
+				hname = ((Npassed.at(j)).GetName());
+				TH1* temp = (TH1*) f->Get(hname);
+				Npassed.at(j).Add(temp, 1.000);
+				hname = ((Npassed_noweight.at(j)).GetName());
+				TH1* tempnw = (TH1*) f->Get(hname);
+				Npassed_noweight.at(j).Add(tempnw, 1.000);
+				for (unsigned int k = 0; k < Extradist1d.size(); k++) {
+					addFromFile(Extradist1d.at(k)->at(j), f);
 				}
-			}
-		}
-		if (file.Contains("root")) {
-			TFile *f = TFile::Open(file, "READ");
-			Logger(Logger::Verbose) << "Selection::LoadResults " << file << std::endl;
-			TString hname;
-			if (f->IsOpen()) {
-				for (unsigned int i = 0; i < Nminus1.size(); i++) {
-					for (unsigned int j = 0; j < Nminus1.at(i).size(); j++) {
-						hname = (Nminus1.at(i).at(j)).GetName();
-						Nminus1.at(i).at(j).Add((TH1*) f->Get(hname), 1.000);
-						hname = (Nminus0.at(i).at(j)).GetName();
-						Nminus0.at(i).at(j).Add((TH1*) f->Get(hname), 1.000);
-						if (distindx.at(i)) {
-							hname = (Nminus1dist.at(i).at(j)).GetName();
-							Nminus1dist.at(i).at(j).Add((TH1*) f->Get(hname), 1.000);
-							hname = (Accumdist.at(i).at(j)).GetName();
-							Accumdist.at(i).at(j).Add((TH1*) f->Get(hname), 1.000);
-						}
-						if (i == 0) {
-							hname = ((Npassed.at(j)).GetName());
-							TH1* temp = (TH1*) f->Get(hname);
-							Npassed.at(j).Add(temp, 1.000);
-							hname = ((Npassed_noweight.at(j)).GetName());
-							TH1* tempnw = (TH1*) f->Get(hname);
-							Npassed_noweight.at(j).Add(tempnw, 1.000);
-							for (unsigned int k = 0; k < Extradist1d.size(); k++) {
-								hname = (Extradist1d.at(k)->at(j)).GetName();
-								Extradist1d.at(k)->at(j).Add((TH1*) f->Get(hname), 1.000);
-							}
-							for (unsigned int k = 0; k < Extradist2d.size(); k++) {
-								TString n = Extradist2d.at(k)->at(j).GetName();
-								if (!n.Contains("egammaMap")) {
-									hname = (Extradist2d.at(k)->at(j)).GetName();
-									Extradist2d.at(k)->at(j).Add((TH1*) f->Get(hname), 1.000);
-								}
-							}
-							for (unsigned int k = 0; k < Extradist3d.size(); k++) {
-								TString n = Extradist3d.at(k)->at(j).GetName();
-								hname = (Extradist3d.at(k)->at(j)).GetName();
-								Extradist3d.at(k)->at(j).Add((TH1*) f->Get(hname), 1.000);
-							}
-
-						}
+				for (unsigned int k = 0; k < Extradist2d.size(); k++) {
+					TString n = Extradist2d.at(k)->at(j).GetName();
+					if (!n.Contains("egammaMap")) {
+						if (sparseExtradist2d.at(k).size() != Extradist2d.at(k)->size())
+							sparseExtradist2d.at(k).resize(Extradist2d.at(k)->size());
+						addFromFile(Extradist2d.at(k)->at(j), sparseExtradist2d.at(k).at(j), f);
 					}
 				}
-				NGoodFiles++;
-			} else {
-				NBadFiles++;
-				Logger(Logger::Warning) << file << " NOT OPENED" << std::endl;
-				ListofBadFiles.push_back(file);
+				for (unsigned int k = 0; k < Extradist3d.size(); k++) {
+					if (sparseExtradist3d.at(k).size() != Extradist3d.at(k)->size())
+						sparseExtradist3d.at(k).resize(Extradist3d.at(k)->size());
+					addFromFile(Extradist3d.at(k)->at(j), sparseExtradist3d.at(k).at(j), f);
+				}
 			}
-			f->Close();
-		} else {
-			NBadFiles++;
-			Logger(Logger::Warning) << "File missing in: " << file << std::endl;
-			ListofBadFiles.push_back(file);
 		}
 	}
+	f->Close();
+	delete f;
+	return true;
+}
+
+// add histogram with the same name from file f, histograms missing in the file are skipped
+void Selection::addFromFile(TH1& h, TFile* f) {
+	TH1* temp = (TH1*) f->Get(h.GetName());
+	if (temp == NULL)
+		return;
+	if (HConfig.isPlaceholder(h))
+		HConfig.Materialize(h);
+	h.Add(temp, 1.000);
+}
+
+// as above, but large 2D/3D histograms are merged into the sparse buffer s as long as h is
+// still a placeholder; the content is moved to h by densifySparse()
+void Selection::addFromFile(TH1& h, SparseHisto& s, TFile* f) {
+	TH1* temp = (TH1*) f->Get(h.GetName());
+	if (temp == NULL)
+		return;
+	if ((!HConfig.isPlaceholder(h) && !s.isValid()) || !HConfig.isSparse(*temp)) {
+		addFromFile(h, f);
+		return;
+	}
+	if (!s.isValid())
+		s = SparseHisto::Like(*temp);
+	s.Add(*temp);
+}
+
+// convert the sparse LoadResults buffers to the dense histograms and release them
+void Selection::densifySparse() {
+	for (unsigned int k = 0; k < sparseExtradist2d.size() && k < Extradist2d.size(); k++) {
+		for (unsigned int j = 0; j < sparseExtradist2d.at(k).size() && j < Extradist2d.at(k)->size(); j++) {
+			if (!sparseExtradist2d.at(k).at(j).isValid())
+				continue;
+			HConfig.Materialize(Extradist2d.at(k)->at(j));
+			sparseExtradist2d.at(k).at(j).AddTo(Extradist2d.at(k)->at(j));
+		}
+	}
+	for (unsigned int k = 0; k < sparseExtradist3d.size() && k < Extradist3d.size(); k++) {
+		for (unsigned int j = 0; j < sparseExtradist3d.at(k).size() && j < Extradist3d.at(k)->size(); j++) {
+			if (!sparseExtradist3d.at(k).at(j).isValid())
+				continue;
+			HConfig.Materialize(Extradist3d.at(k)->at(j));
+			sparseExtradist3d.at(k).at(j).AddTo(Extradist3d.at(k)->at(j));
+		}
+	}
+	std::vector<std::vector<SparseHisto> >().swap(sparseExtradist2d);
+	std::vector<std::vector<SparseHisto> >().swap(sparseExtradist3d);
 }
 
 bool Selection::AnalysisCuts(int t, double w, double wobjs) {
@@ -142,49 +211,32 @@ bool Selection::AnalysisCuts(int t, double w, double wobjs) {
 		Selection::ConfigureHistograms();
 	}
 	if (0 <= t && t < (int) types.size()) {
-		int nfail = 0;
-		int fail = -1;
-		Npassed.at(t).Fill(-0.5, w);
-		Npassed_noweight.at(t).Fill(-0.5, 1);
-		for (int i = 0; i < ncuts; i++) {
-			if (!pass.at(i)) {
-				fail = i;
-				nfail++;
-			}
-			if (nfail == 0) {
-				Npassed.at(t).Fill((float) i + 0.5, w * wobjs);
-				Npassed_noweight.at(t).Fill((float) i + 0.5, 1);
-				if (i + 1 < ncuts) {
-					if (distindx.at(i + 1)) {
-						for (unsigned int k = 0; k < dist.at(i + 1).size(); k++) {
-							Accumdist.at(i + 1).at(t).Fill(dist.at(i + 1).at(k), w * wobjs);
-						}
-					}
-				}
-				if (i == 0) {
-					if (distindx.at(i)) {
-						for (unsigned int k = 0; k < dist.at(i).size(); k++) {
-							Accumdist.at(i).at(t).Fill(dist.at(i).at(k), w * wobjs);
-						}
-					}
-				}
-			}
+		if (fastIsInit.size() <= (unsigned int) t || !fastIsInit.at(t))
+			initFastHistos(t);
+		int nfail = pass.nFailed();
+		double wcut = w * wobjs;
+		fastNpassed.at(t).Fill(-0.5, w);
+		fastNpassed_noweight.at(t).Fill(-0.5, 1);
+		// cut flow: all cuts before the first failing cut
+		int npassed = nfail ? pass.firstFailed() : ncuts;
+		if (npassed > 0 && distindx[0] && dist[0].size() > 0)
+			fastAccumdist[0][t].FillN(dist[0].size(), &dist[0][0], wcut);
+		for (int i = 0; i < npassed; i++) {
+			fastNpassed[t].Fill((float) i + 0.5, wcut);
+			fastNpassed_noweight[t].Fill((float) i + 0.5, 1);
+			if (i + 1 < ncuts && distindx[i + 1] && dist[i + 1].size() > 0)
+				fastAccumdist[i + 1][t].FillN(dist[i + 1].size(), &dist[i + 1][0], wcut);
 		}
 		if (nfail <= 1) {
-			for (int i = 0; i < ncuts; i++) {
-				if (fail == i || nfail == 0) {
-					Nminus1.at(i).at(t).Fill(value.at(i), w * wobjs);
-					if (distindx.at(i)) {
-						for (unsigned int k = 0; k < dist.at(i).size(); k++) {
-							Nminus1dist.at(i).at(t).Fill(dist.at(i).at(k), w * wobjs);
-						}
-					}
-				}
+			// N-1: the failing cut, or every cut if all passed
+			for (int i = (nfail ? npassed : 0); i < (nfail ? npassed + 1 : ncuts); i++) {
+				fastNminus1[i][t].Fill(value[i], wcut);
+				if (distindx[i] && dist[i].size() > 0)
+					fastNminus1dist[i][t].FillN(dist[i].size(), &dist[i][0], wcut);
 			}
-
 			if (nfail == 0) {
 				for (int i = 0; i < ncuts; i++) {
-					Nminus0.at(i).at(t).Fill(value.at(i), w * wobjs);
+					fastNminus0[i][t].Fill(value[i], wcut);
 				}
 				return true;
 			}
@@ -193,6 +245,61 @@ bool Selection::AnalysisCuts(int t, double w, double wobjs) {
 	return false;
 }
 
+// create the event loop buffers of the cut flow histograms for type t
+void Selection::initFastHistos(unsigned int t) {
+	unsigned int ntypes = types.size();
+	unsigned int ncuts = Nminus1.size();
+	if (fastIsInit.size() != ntypes) {
+		fastIsInit.assign(ntypes, false);
+		fastNpassed.assign(ntypes, FastHisto());
+		fastNpassed_noweight.assign(ntypes, FastHisto());
+		fastNminus1.assign(ncuts, std::vector<FastHisto>(ntypes));
+		fastNminus0.assign(ncuts, std::vector<FastHisto>(ntypes));
+		fastNminus1dist.assign(ncuts, std::vector<FastHisto>(ntypes));
+		fastAccumdist.assign(ncuts, std::vector<FastHisto>(ntypes));
+	}
+	materializeType(t);
+	fastNpassed.at(t) = FastHisto::Like(Npassed.at(t));
+	fastNpassed_noweight.at(t) = FastHisto::Like(Npassed_noweight.at(t));
+	for (unsigned int i = 0; i < ncuts; i++) {
+		fastNminus1.at(i).at(t) = FastHisto::Like(Nminus1.at(i).at(t));
+		fastNminus0.at(i).at(t) = FastHisto::Like(Nminus0.at(i).at(t));
+		if (distindx.at(i)) {
+			fastNminus1dist.at(i).at(t) = FastHisto::Like(Nminus1dist.at(i).at(t));
+			fastAccumdist.at(i).at(t) = FastHisto::Like(Accumdist.at(i).at(t));
+		}
+	}
+	fastIsInit.at(t) = true;
+}
+
+// transfer the content of the event loop buffers to the ROOT histograms
+void Selection::flushFastHistos() {
+	for (unsigned int t = 0; t < fastIsInit.size(); t++) {
+		if (!fastIsInit.at(t))
+			continue;
+		fastNpassed.at(t).AddTo(Npassed.at(t));
+		fastNpassed.at(t).Reset();
+		fastNpassed_noweight.at(t).AddTo(Npassed_noweight.at(t));
+		fastNpassed_noweight.at(t).Reset();
+		for (unsigned int i = 0; i < fastNminus1.size(); i++) {
+			fastNminus1.at(i).at(t).AddTo(Nminus1.at(i).at(t));
+			fastNminus1.at(i).at(t).Reset();
+			fastNminus0.at(i).at(t).AddTo(Nminus0.at(i).at(t));
+			fastNminus0.at(i).at(t).Reset();
+			if (distindx.at(i)) {
+				fastNminus1dist.at(i).at(t).AddTo(Nminus1dist.at(i).at(t));
+				fastNminus1dist.at(i).at(t).Reset();
+				fastAccumdist.at(i).at(t).AddTo(Accumdist.at(i).at(t));
+				fastAccumdist.at(i).at(t).Reset();
+			}
+		}
+	}
+}
+
+void Selection::EndOfEventLoop() {
+	flushFastHistos();
+}
+
 void Selection::Finish() {
 	if (Npassed.size() != Npassed_noweight.size()) {
 		Logger(Logger::Error) << "Histograms not Configured. Please fix your code!!!! Running Selection::ConfigureHistograms()" << std::endl;
@@ -201,6 +308,10 @@ void Selection::Finish() {
 	if (!isStored) {
 		ConfigureHistograms();
 	}
+	flushFastHistos();
+	densifySparse();
+	if (runtype != GRID)
+		materializeAllTypes();
 	Logger(Logger::Info) << "Writing out " + Name + ".root ..." << std::endl;
 	TString fName;
 	if (runtype == GRID)
@@ -233,50 +344,51 @@ void Selection::Finish() {
 		// weight all Histograms
 		Logger(Logger::Info) << "#### Scale factors for MC samples:" << std::endl;
 		printf("%8s %10s : %7s * %9s / %10s = %6s \n", "Position", "DataMCType", "Lumi", "xsec*acc.", "N(events)", "Scale");
+		std::vector<double> scale(CrossSectionandAcceptance.size(), 1.0);
+		// number of events before the histograms (also Npassed) are scaled
+		std::vector<double> nEvents(CrossSectionandAcceptance.size(), 0.0);
+		for (unsigned int i = 0; i < nEvents.size(); i++)
+			nEvents.at(i) = Npassed.at(i).GetBinContent(0);
 		for (unsigned int i = 0; i < CrossSectionandAcceptance.size(); i++) {
-			printf("%8d %10d : %7.1f * %9.4f / %10.0f = %6f", i, HConfig.GetID(i), Lumi, CrossSectionandAcceptance.at(i), Npassed.at(i).GetBinContent(0),
-					Lumi * CrossSectionandAcceptance.at(i) / Npassed.at(i).GetBinContent(0));
+			printf("%8d %10d : %7.1f * %9.4f / %10.0f = %6f", i, HConfig.GetID(i), Lumi, CrossSectionandAcceptance.at(i), nEvents.at(i),
+					Lumi * CrossSectionandAcceptance.at(i) / nEvents.at(i));
 			if (CrossSectionandAcceptance.at(i) > 0) {
-				ScaleAllHistOfType(i, Lumi * CrossSectionandAcceptance.at(i) / Npassed.at(i).GetBinContent(0));
+				scale.at(i) = Lumi * CrossSectionandAcceptance.at(i) / nEvents.at(i);
+				ScaleAllHistOfType(i, scale.at(i));
 				printf("\n");
 			} else
 				printf("  --> will not be scaled \n");
 		}
-		Save(fName + "_LumiScaled");      // Save file with Lumi-scaled events - required for combining code
+		// the output file keeps the unscaled histograms, the scale factors are stored next to them
+		SaveScaleFactors(fName, scale, nEvents);
 		histsAreScaled = true;
 
 		///Now make the plots
 		Logger(Logger::Info) << "Printing Plots " << std::endl;
-		system("rm EPS/*.eps");
-		Plots P;
-		P.Plot1D(Nminus1, colour, legend);
+		// one family per histogram, drawn by forked workers; unchanged families are not redrawn
+		PlotRenderer R(Name, colour, legend);
 		for (unsigned int i = 0; i < Nminus1.size(); i++) {
-			P.Plot1DSignificance(Nminus1.at(i), true, false, colour, legend);
-			P.Plot1DSignificance(Nminus1.at(i), false, true, colour, legend);
-			P.Plot1Dsigtobkg(Nminus1.at(i), true, false, colour, legend);
-			P.Plot1Dsigtobkg(Nminus1.at(i), false, true, colour, legend);
-			P.Plot1D_DataMC_Compare(Nminus1.at(i), colour, legend);
+			R.Add1D(Nminus1.at(i), i, true);
+		}
+		for (unsigned int i = 0; i < Nminus0.size(); i++) {
+			R.Add1D(Nminus0.at(i), i, false);
+		}
+		for (unsigned int i = 0; i < Nminus1dist.size(); i++) {
+			R.Add1D(Nminus1dist.at(i), i, false);
+		}
+		for (unsigned int i = 0; i < Accumdist.size(); i++) {
+			R.Add1D(Accumdist.at(i), i, false);
 		}
-		P.Plot1D(Nminus0, colour, legend);
-		P.Plot1D(Nminus1dist, colour, legend);
-		P.Plot1D(Accumdist, colour, legend);
-
 		for (unsigned int i = 0; i < Extradist1d.size(); i++) {
-			P.Plot1D((*Extradist1d.at(i)), colour, legend);
-			if (Lumi > 0) {
-				P.Plot1DSignificance((*Extradist1d.at(i)), true, false, colour, legend);
-				P.Plot1DSignificance((*Extradist1d.at(i)), false, true, colour, legend);
-				P.Plot1Dsigtobkg((*Extradist1d.at(i)), true, false, colour, legend);
-				P.Plot1Dsigtobkg((*Extradist1d.at(i)), false, true, colour, legend);
-				P.Plot1D_DataMC_Compare((*Extradist1d.at(i)), colour, legend);
-			}
+			R.Add1D((*Extradist1d.at(i)), 0, Lumi > 0);
 		}
 		for (unsigned int i = 0; i < Extradist2d.size(); i++) {
-			P.Plot2D((*Extradist2d.at(i)), colour, legend);
+			R.Add2D((*Extradist2d.at(i)));
 		}
 		for (unsigned int i = 0; i < Extradist3d.size(); i++) {
-			P.Plot3D((*Extradist3d.at(i)), colour, legend);
+			R.Add3D((*Extradist3d.at(i)));
 		}
+		R.Render("EPS/");
 
 		Logger(Logger::Info) << "Writing out " << Name << ".tex" << std::endl;
 		T.MakeEffTable(Npassed, title, Lumi, CrossSectionandAcceptance);
@@ -287,27 +399,71 @@ void Selection::Finish() {
 
 }
 
+// Append the per-type lumi scale factors to the output file fName as TTree "LumiScaleFactors"
+// (one entry per type: name, DataMCType, lumi, xsec*acc, N(events), scale). Readers scale the
+// histograms of a type on the fly with the stored factor instead of reading a second, scaled file.
+void Selection::SaveScaleFactors(TString fName, const std::vector<double>& scale, const std::vector<double>& nEvents) {
+	TFile f(fName + ".root", "UPDATE");
+	if (f.IsZombie()) {
+		Logger(Logger::Error) << "Could not open " << fName << ".root to store scale factors." << std::endl;
+		return;
+	}
+	Int_t type;
+	Long64_t id;
+	Char_t name[256];
+	Double_t lumi, xsec, n, sf;
+	TTree t("LumiScaleFactors", "lumi scale factors per type");
+	t.Branch("type", &type, "type/I");
+	t.Branch("id", &id, "id/L");
+	t.Branch("name", name, "name/C");
+	t.Branch("lumi", &lumi, "lumi/D");
+	t.Branch("xsec", &xsec, "xsec/D");
+	t.Branch("nEvents", &n, "nEvents/D");
+	t.Branch("scale", &sf, "scale/D");
+	for (unsigned int i = 0; i < scale.size(); i++) {
+		type = i;
+		id = types.at(i);
+		strncpy(name, HConfig.GetName(i).Data(), sizeof(name) - 1);
+		name[sizeof(name) - 1] = '\0';
+		lumi = Lumi;
+		xsec = CrossSectionandAcceptance.at(i);
+		n = nEvents.at(i);
+		sf = scale.at(i);
+		t.Fill();
+	}
+	t.Write();
+	f.Close();
+}
+
+// histograms of types which have not been used (lazy placeholders) are not written
 void Selection::Save(TString fName) {
 	TFile f(fName + ".root", "RECREATE");
 	for (unsigned int i = 0; i < Nminus1.size(); i++) {
 		for (unsigned int j = 0; j < Nminus1.at(i).size(); j++) {
-			Nminus1.at(i).at(j).Write((Nminus1.at(i).at(j)).GetName());
-			Nminus0.at(i).at(j).Write((Nminus0.at(i).at(j)).GetName());
+			if (!HConfig.isPlaceholder(Nminus1.at(i).at(j)))
+				Nminus1.at(i).at(j).Write((Nminus1.at(i).at(j)).GetName());
+			if (!HConfig.isPlaceholder(Nminus0.at(i).at(j)))
+				Nminus0.at(i).at(j).Write((Nminus0.at(i).at(j)).GetName());
 			if (distindx.at(i)) {
-				Nminus1dist.at(i).at(j).Write((Nminus1dist.at(i).at(j)).GetName());
-				Accumdist.at(i).at(j).Write((Accumdist.at(i).at(j)).GetName());
+				if (!HConfig.isPlaceholder(Nminus1dist.at(i).at(j)))
+					Nminus1dist.at(i).at(j).Write((Nminus1dist.at(i).at(j)).GetName());
+				if (!HConfig.isPlaceholder(Accumdist.at(i).at(j)))
+					Accumdist.at(i).at(j).Write((Accumdist.at(i).at(j)).GetName());
 			}
 			if (i == 0) {
 				Npassed.at(j).Write((Npassed.at(j)).GetName());
 				Npassed_noweight.at(j).Write((Npassed_noweight.at(j)).GetName());
 				for (unsigned int i = 0; i < Extradist1d.size(); i++) {
-					Extradist1d.at(i)->at(j).Write((Extradist1d.at(i)->at(j)).GetName());
+					if (!HConfig.isPlaceholder(Extradist1d.at(i)->at(j)))
+						Extradist1d.at(i)->at(j).Write((Extradist1d.at(i)->at(j)).GetName());
 				}
 				for (unsigned int i = 0; i < Extradist2d.size(); i++) {
-					Extradist2d.at(i)->at(j).Write((Extradist2d.at(i)->at(j)).GetName());
+					if (!HConfig.isPlaceholder(Extradist2d.at(i)->at(j)))
+						Extradist2d.at(i)->at(j).Write((Extradist2d.at(i)->at(j)).GetName());
 				}
 				for (unsigned int i = 0; i < Extradist3d.size(); i++) {
-					Extradist3d.at(i)->at(j).Write((Extradist3d.at(i)->at(j)).GetName());
+					if (!HConfig.isPlaceholder(Extradist3d.at(i)->at(j)))
+						Extradist3d.at(i)->at(j).Write((Extradist3d.at(i)->at(j)).GetName());
 				}
 			}
 		}
@@ -315,23 +471,37 @@ void Selection::Save(TString fName) {
 	f.Close();
 }
 
-bool Selection::Passed() {
-	for (unsigned int i = 0; i < pass.size(); i++) {
-		if (!pass.at(i))
+// true if all cuts up to (and including) lastCut passed, apart from the nIgnore cuts in ignore
+bool Selection::passedCuts(const unsigned int* ignore, unsigned int nIgnore, unsigned int lastCut) const {
+	CutMask ignoreMask = 0;
+	for (unsigned int k = 0; k < nIgnore; k++)
+		ignoreMask |= CutBit(ignore[k]);
+	CutMask apply = lastCut + 1 < MaxCuts ? CutBit(lastCut + 1) - 1 : ~((CutMask) 0);
+	if ((failedCuts() & apply & ~ignoreMask) != 0)
+		return false;
+	if (pass.nFailedBeyondMask() == 0 || lastCut < MaxCuts)
+		return true;
+	// cuts beyond the mask are checked one by one
+	for (unsigned int i = MaxCuts; i <= lastCut && i < pass.size(); i++) {
+		if (!pass[i] && std::find(ignore, ignore + nIgnore, i) == ignore + nIgnore)
 			return false;
 	}
 	return true;
 }
 
+bool Selection::Passed() {
+	return pass.allPassed();
+}
+
 bool Selection::NMinusL(int a, int b, int c, int d, int e) {
-	bool good = true;
-	for (int i = 0; i < (int) pass.size(); i++) {
-		if (i != a && i != b && i != c && i != d && i != e) {
-			if (!pass.at(i))
-				good = false;
-		}
+	unsigned int ignore[5];
+	unsigned int nIgnore = 0;
+	int excluded[5] = { a, b, c, d, e };
+	for (unsigned int k = 0; k < 5; k++) {
+		if (excluded[k] >= 0)
+			ignore[nIgnore++] = excluded[k];
 	}
-	return good;
+	return passedCuts(ignore, nIgnore, pass.size());
 }
 
 bool Selection::NMinus1(int a) {
@@ -408,6 +578,92 @@ TString Selection::splitString(const std::string &s, char delim, std::string spl
 	return outstring;
 }
 
+// Streaming version of EvaluateSystematics: the histograms of systematic sysType are read one
+// at a time from the (merged) job outputs, no Selection for the systematic is created.
+// Histograms missing in the output count as empty, as in LoadResults.
+void Selection::EvaluateSystematics(TString sysType, std::vector<TString> files, double w) {
+	TString sysName = Get_Analysis() + "_" + sysType;
+	std::vector<TString> inputs = HistoMerger::ResolveFiles(files, sysName + ".root");
+	std::vector<TString> readable;
+	for (unsigned int f = 0; f < inputs.size(); f++) {
+		if (inputs.at(f).Contains("root"))
+			readable.push_back(inputs.at(f));
+		else
+			Logger(Logger::Warning) << "File missing in: " << inputs.at(f) << std::endl;
+	}
+	if (readable.size() == 0) {
+		Logger(Logger::Error) << "No files for systematic " << sysName << ". Systematic not evaluated." << std::endl;
+		return;
+	}
+	TString input = readable.at(0);
+	if (readable.size() > 1) {
+		unsigned int nGood;
+		std::vector<TString> bad;
+		if (!HistoMerger::MergeCached(sysName, readable, input, nGood, bad)) {
+			Logger(Logger::Error) << "Merging of systematic " << sysName << " failed. Systematic not evaluated." << std::endl;
+			return;
+		}
+		for (unsigned int f = 0; f < bad.size(); f++)
+			Logger(Logger::Warning) << bad.at(f) << " NOT OPENED" << std::endl;
+	}
+	TFile *f = TFile::Open(input, "READ");
+	if (f == NULL || !f->IsOpen()) {
+		Logger(Logger::Error) << input << " NOT OPENED. Systematic " << sysName << " not evaluated." << std::endl;
+		delete f;
+		return;
+	}
+	// key list is read once, the newest cycle of each name comes first
+	std::map<TString, TKey*> keys;
+	TIter next(f->GetListOfKeys());
+	TKey *key;
+	while ((key = (TKey*) next())) {
+		if (keys.find(key->GetName()) == keys.end())
+			keys[key->GetName()] = key;
+	}
+	for (unsigned int j = 0; j < Npassed.size(); j++) {
+		addSystematicError(Npassed.at(j), keys, sysName, w, Npassed.at(j).GetNbinsX(), true);
+		for (unsigned int k = 0; k < Nminus1.size(); k++) {
+			addSystematicError(Nminus1.at(k).at(j), keys, sysName, w, Nminus1.at(k).at(j).GetNbinsX());
+			addSystematicError(Nminus0.at(k).at(j), keys, sysName, w, Nminus0.at(k).at(j).GetNbinsX());
+			if (distindx.at(k)) {
+				addSystematicError(Nminus1dist.at(k).at(j), keys, sysName, w, Nminus1dist.at(k).at(j).GetNbinsX());
+				addSystematicError(Accumdist.at(k).at(j), keys, sysName, w, Accumdist.at(k).at(j).GetNbinsX());
+			}
+		}
+		for (unsigned int k = 0; k < Extradist1d.size(); k++) {
+			addSystematicError(Extradist1d.at(k)->at(j), keys, sysName, w, Extradist1d.at(k)->at(j).GetNbinsX());
+		}
+		for (unsigned int k = 0; k < Extradist2d.size(); k++) {
+			TH2D &h = Extradist2d.at(k)->at(j);
+			addSystematicError(h, keys, sysName, w, h.GetBin(h.GetNbinsX(), h.GetNbinsY()));
+		}
+	}
+	f->Close();
+	delete f;
+}
+
+// add w*(systematic - nominal) in quadrature to the errors of bins 0..lastBin of h;
+// the systematic histogram is the one with the name of h for selection sysName
+void Selection::addSystematicError(TH1& h, std::map<TString, TKey*>& keys, TString sysName, double w, int lastBin, bool onlyFilled) {
+	TString name = h.GetName();
+	TH1 *sys = NULL;
+	if (!name.Contains("egammaMap")) {
+		if (name.BeginsWith(Name))
+			name.Replace(0, Name.Length(), sysName);
+		std::map<TString, TKey*>::iterator it = keys.find(name);
+		if (it != keys.end())
+			sys = (TH1*) it->second->ReadObj();
+	}
+	for (int l = 0; l <= lastBin; l++) {
+		if (onlyFilled && h.GetBinContent(l) == 0)
+			continue;
+		double err = h.GetBinError(l);
+		double sysContent = sys != NULL ? sys->GetBinContent(l) : 0;
+		h.SetBinError(l, sqrt(err * err + w * w * pow(sysContent - h.GetBinContent(l), 2.0)));
+	}
+	delete sys;
+}
+
 void Selection::ResetEvent() {
 	for (unsigned int i = 0; i < pass.size(); i++) {
 		pass.at(i) = false;
@@ -470,31 +726,17 @@ void Selection::suppressDrawingHistOfType(unsigned int t) {
 // Returns true, if all cuts except for those in vector 'indices' passed.
 // Elements of vector 'indices' are the indices i_cut of the vector cut
 bool Selection::passAllBut(std::vector<unsigned int> indices) {
-	std::vector<unsigned int>::iterator it;
-	for (unsigned int i_cut = 0; i_cut < pass.size(); i_cut++) {
-		it = std::find(indices.begin(), indices.end(), i_cut);	// tries to find i_cut in vector 'indices'
-		if (i_cut != *it) {											// checks if cut at i_cut is not a cut you want to exclude
-			if (!pass.at(i_cut))
-				return false;						// checks whether cut passed or not
-		}
-	}
-	return true;
+	return passedCuts(indices.empty() ? NULL : &indices.at(0), indices.size(), pass.size());
 }
 
 bool Selection::passAllBut(unsigned int i_cut) {
-	std::vector<unsigned int> index;
-	index.push_back(i_cut);
-	return passAllBut(index);
+	return passedCuts(&i_cut, 1, pass.size());
 }
 
 // Checks if all cuts up to (and including) the given cut have passed
 // Cuts after the given cut index are ignored
 bool Selection::passAllUntil(unsigned int lastCutToApply) {
-	for (unsigned int i_cut = 0; i_cut <= lastCutToApply; i_cut++) {
-		if (!pass.at(i_cut))
-			return false;
-	}
-	return true;
+	return passedCuts(NULL, 0, lastCutToApply);
 }
 
 // calculate scale factor for a given DataMCType
@@ -512,3 +754,37 @@ double Selection::scaleFactorToLumi(unsigned int id){
 
 	return Lumi * xsec / nEvts;
 }
+
+// allocate the histograms of type t which have been booked as placeholders
+void Selection::materializeType(unsigned int t) {
+	for (unsigned int i = 0; i < Nminus1.size(); i++) {
+		if (Nminus1.at(i).size() > t)
+			HConfig.Materialize(Nminus1.at(i).at(t));
+		if (Nminus0.at(i).size() > t)
+			HConfig.Materialize(Nminus0.at(i).at(t));
+		if (distindx.at(i)) {
+			if (Nminus1dist.at(i).size() > t)
+				HConfig.Materialize(Nminus1dist.at(i).at(t));
+			if (Accumdist.at(i).size() > t)
+				HConfig.Materialize(Accumdist.at(i).at(t));
+		}
+	}
+	for (unsigned int k = 0; k < Extradist1d.size(); k++) {
+		if (Extradist1d.at(k)->size() > t)
+			HConfig.Materialize(Extradist1d.at(k)->at(t));
+	}
+	for (unsigned int k = 0; k < Extradist2d.size(); k++) {
+		if (Extradist2d.at(k)->size() > t)
+			HConfig.Materialize(Extradist2d.at(k)->at(t));
+	}
+	for (unsigned int k = 0; k < Extradist3d.size(); k++) {
+		if (Extradist3d.at(k)->size() > t)
+			HConfig.Materialize(Extradist3d.at(k)->at(t));
+	}
+}
+
+void Selection::materializeAllTypes() {
+	for (unsigned int t = 0; t < types.size(); t++) {
+		materializeType(t);
+	}
+}
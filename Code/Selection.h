@@ -6,14 +6,20 @@
 #include "TH1D.h"
 #include "TH2D.h"
 #include <vector>
+#include <map>
+#include "TKey.h"
 #include "HistoConfig.h"
+#include "FastHisto.h"
+#include "SparseHisto.h"
+#include "CutResults.h"
 
-class Selection : public Selection_Base {
+class Selection : public Selection_Base, public HistoConfig::TypeListener {
 
  public:
   Selection(TString Name_, TString id_);
   virtual ~Selection();
 
+  virtual void  EndOfEventLoop();
   virtual void  Finish();
   virtual void  LoadResults(std::vector<TString> files);
 
@@ -35,9 +41,14 @@ class Selection : public Selection_Base {
   virtual double Compute(double thisdata,double thissignal, double thissignalTotal, double thisbkg,double data,double signal,
 			 double signalTotal, double bkg);
   virtual void EvaluateSystematics(Selection_Base* &selectionsys, double w);
+  virtual void EvaluateSystematics(TString sysType, std::vector<TString> files, double w);
   static TString splitString(const std::string &s, char delim, std::string splitpoint);
 
   void Save(TString fName);
+  void SaveScaleFactors(TString fName, const std::vector<double>& scale, const std::vector<double>& nEvents);
+
+  // lazy histogram allocation (see HistoConfig)
+  virtual void TypeUsed(unsigned int t){materializeType(t);}
 
  protected:
   virtual bool AnalysisCuts(int t,double w,double wobjs=1.0);
@@ -51,7 +62,22 @@ class Selection : public Selection_Base {
   bool passAllBut(std::vector<unsigned int> index);
   bool passAllBut(unsigned int i_cut);
   bool passAllUntil(unsigned int i_cut);
+  // cut results as bit mask: bit i is set if cut i failed (the first MaxCuts cuts, see CutResults)
+  typedef CutResults::Mask CutMask;
+  static const unsigned int MaxCuts = CutResults::MaskBits;
+  static CutMask CutBit(unsigned int i){return CutResults::Bit(i);}
+  CutMask failedCuts() const {return pass.failedMask();}
   double scaleFactorToLumi(unsigned int id);
+  void materializeType(unsigned int t);
+  void materializeAllTypes();
+  bool loadFile(TString file);
+  void addSystematicError(TH1& h, std::map<TString, TKey*>& keys, TString sysName, double w, int lastBin, bool onlyFilled = false);
+  void addFromFile(TH1& h, TFile* f);
+  void addFromFile(TH1& h, SparseHisto& s, TFile* f);
+  void densifySparse();
+  void initFastHistos(unsigned int t);
+  void flushFastHistos();
+  bool passedCuts(const unsigned int* ignore, unsigned int nIgnore, unsigned int lastCut) const;
 
   HistoConfig HConfig;
 
@@ -74,7 +100,7 @@ class Selection : public Selection_Base {
   std::vector<std::vector<TH2D>* >  Extradist2d;
   std::vector<std::vector<TH3F>* > Extradist3d;
   std::vector<float> value; 
-  std::vector<bool>  pass; 
+  CutResults         pass; 
   std::vector<float> cut; 
   std::vector<std::vector<float> > dist; 
   std::vector<bool>   distindx;
@@ -86,6 +112,19 @@ class Selection : public Selection_Base {
   bool histsAreScaled; // info if histograms have been scaled already or not
 
  private:
+  // event loop buffers of the cut flow histograms, transferred to the TH1D by flushFastHistos()
+  std::vector<bool>                      fastIsInit;      //[type]
+  std::vector<FastHisto>                 fastNpassed;     //[type]
+  std::vector<FastHisto>                 fastNpassed_noweight; //[type]
+  std::vector<std::vector<FastHisto> >   fastNminus1;     //[cut][type]
+  std::vector<std::vector<FastHisto> >   fastNminus0;     //[cut][type]
+  std::vector<std::vector<FastHisto> >   fastNminus1dist; //[cut][type]
+  std::vector<std::vector<FastHisto> >   fastAccumdist;   //[cut][type]
+
+  // LoadResults buffers of large 2D/3D histograms, converted to the TH2D/TH3F by densifySparse()
+  std::vector<std::vector<SparseHisto> > sparseExtradist2d; //[k][type]
+  std::vector<std::vector<SparseHisto> > sparseExtradist3d; //[k][type]
+
   bool isStored;
   unsigned int data;
 
@@ -20,6 +20,7 @@ class Selection_Base {
 
 
   virtual void  Configure()=0;
+  virtual void  EndOfEventLoop(){};
   virtual void  Finish()=0;
   virtual void  LoadResults(std::vector<TString> files)=0;
   virtual bool Passed()=0;
@@ -29,6 +30,7 @@ class Selection_Base {
   virtual TString Get_SysType(){return systype;};
   virtual void Set_Ntuple(Ntuple_Controller *Ntp_){Ntp=Ntp_;isNtp=true;sysid=Ntp->SetupSystematics(systype);}
   virtual void EvaluateSystematics(Selection_Base* &selectionsys, double w)=0;
+  virtual void EvaluateSystematics(TString systype, std::vector<TString> files, double w)=0;
 
   enum SelectionMode {ANALYSIS,RECONSTRUCT};
   enum RunType {GRID,Local};
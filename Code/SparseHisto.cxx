@@ -0,0 +1,173 @@
+/*
+ * SparseHisto.cxx
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SparseHisto.h"
+#include "TAxis.h"
+#include "TArrayD.h"
+#include "SimpleFits/FitSoftware/interface/Logger.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+	inline ULong64_t hashBin(Long64_t bin){
+		// Fibonacci hashing, the table size is a power of 2
+		return (ULong64_t)bin * 0x9E3779B97F4A7C15ULL;
+	}
+}
+
+SparseHisto::SparseHisto():
+	dim(0),
+	entries(0)
+{
+	n[0] = n[1] = n[2] = 0;
+	memset(stats, 0, sizeof(stats));
+}
+
+SparseHisto::~SparseHisto() {
+}
+
+SparseHisto SparseHisto::Like(const TH1& h){
+	SparseHisto s;
+	if(h.GetDimension()<2){
+		Logger(Logger::Error) << "SparseHisto supports only 2D and 3D histograms. " << h.GetName() << " is ignored." << std::endl;
+		return s;
+	}
+	s.dim = h.GetDimension();
+	const TAxis* axis[3] = {h.GetXaxis(), h.GetYaxis(), h.GetZaxis()};
+	for(int d=0; d<s.dim; d++) s.n[d] = axis[d]->GetNbins();
+	s.Rehash(64);
+	return s;
+}
+
+bool SparseHisto::SameBinning(const TH1& h) const{
+	if(h.GetDimension()!=dim) return false;
+	if(h.GetNbinsX()!=n[0] || h.GetNbinsY()!=n[1]) return false;
+	if(dim==3 && h.GetNbinsZ()!=n[2]) return false;
+	return true;
+}
+
+bool SparseHisto::SameBinning(const SparseHisto& o) const{
+	return dim==o.dim && n[0]==o.n[0] && n[1]==o.n[1] && n[2]==o.n[2];
+}
+
+Long64_t SparseHisto::FindSlot(Long64_t bin) const{
+	ULong64_t mask = table.size() - 1;
+	ULong64_t slot = hashBin(bin) & mask;
+	while(table[slot]>=0 && keys[table[slot]]!=bin){
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+void SparseHisto::Rehash(unsigned int newSize){
+	table.assign(newSize, -1);
+	for(unsigned int i=0; i<keys.size(); i++){
+		table[FindSlot(keys[i])] = i;
+	}
+}
+
+void SparseHisto::AddBinContent(Long64_t bin, double w, double w2){
+	if(table.empty()) return;
+	Long64_t slot = FindSlot(bin);
+	if(table[slot]<0){
+		// keep the load factor below 1/2
+		if(2*(keys.size()+1) > table.size()){
+			Rehash(2*table.size());
+			slot = FindSlot(bin);
+		}
+		table[slot] = keys.size();
+		keys.push_back(bin);
+		sumw.push_back(0.);
+		sumw2.push_back(0.);
+	}
+	sumw[table[slot]] += w;
+	sumw2[table[slot]] += w2;
+}
+
+bool SparseHisto::Add(const TH1& h, double c){
+	if(!SameBinning(h)){
+		Logger(Logger::Error) << "Binning of " << h.GetName() << " does not match. Content not added." << std::endl;
+		return false;
+	}
+	const TArrayD* hsumw2 = h.GetSumw2();
+	bool hasSumw2 = h.GetSumw2N()>0;
+	Long64_t ncells = (Long64_t)(n[0]+2) * (n[1]+2) * (dim==3 ? n[2]+2 : 1);
+	for(Long64_t bin=0; bin<ncells; bin++){
+		double w = h.GetBinContent(bin);
+		double w2 = hasSumw2 ? hsumw2->fArray[bin] : fabs(w);
+		if(w==0 && w2==0) continue;
+		AddBinContent(bin, c*w, c*c*w2);
+	}
+	entries += h.GetEntries();
+	// as TH1::Add
+	double hstats[13] = {0.};
+	h.GetStats(hstats);
+	for(int i=0; i<13; i++) stats[i] += (i==1 ? c*c : c) * hstats[i];
+	return true;
+}
+
+bool SparseHisto::Add(const SparseHisto& o){
+	if(!SameBinning(o)){
+		Logger(Logger::Error) << "Binning of sparse histograms does not match. Content not added." << std::endl;
+		return false;
+	}
+	for(unsigned int i=0; i<o.keys.size(); i++){
+		AddBinContent(o.keys[i], o.sumw[i], o.sumw2[i]);
+	}
+	entries += o.entries;
+	for(int i=0; i<13; i++) stats[i] += o.stats[i];
+	return true;
+}
+
+bool SparseHisto::AddTo(TH1& h) const{
+	if(!SameBinning(h)){
+		Logger(Logger::Error) << "Binning of " << h.GetName() << " does not match. Content not added." << std::endl;
+		return false;
+	}
+	if(keys.empty()) return true;
+	if(h.GetSumw2N()==0) h.Sumw2();
+	double oldEntries = h.GetEntries();
+	double hstats[13] = {0.};
+	h.GetStats(hstats);
+	TArrayD* hsumw2 = h.GetSumw2();
+	for(unsigned int i=0; i<keys.size(); i++){
+		h.AddBinContent(keys[i], sumw[i]);
+		hsumw2->fArray[keys[i]] += sumw2[i];
+	}
+	for(int i=0; i<13; i++) hstats[i] += stats[i];
+	h.PutStats(hstats);
+	h.SetEntries(oldEntries + entries);
+	return true;
+}
+
+void SparseHisto::Scale(double c){
+	for(unsigned int i=0; i<keys.size(); i++){
+		sumw[i] *= c;
+		sumw2[i] *= c*c;
+	}
+	for(int i=0; i<13; i++) stats[i] *= (i==1 ? c*c : c);
+}
+
+void SparseHisto::Swap(SparseHisto& o){
+	std::swap(dim, o.dim);
+	for(int d=0; d<3; d++) std::swap(n[d], o.n[d]);
+	std::swap(entries, o.entries);
+	for(int i=0; i<13; i++) std::swap(stats[i], o.stats[i]);
+	table.swap(o.table);
+	keys.swap(o.keys);
+	sumw.swap(o.sumw);
+	sumw2.swap(o.sumw2);
+}
+
+void SparseHisto::Reset(){
+	keys.clear();
+	sumw.clear();
+	sumw2.clear();
+	if(dim>0) Rehash(64);
+	entries = 0;
+	memset(stats, 0, sizeof(stats));
+}
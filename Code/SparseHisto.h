@@ -0,0 +1,64 @@
+/*
+ * SparseHisto.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ *      Sparse storage for 2D/3D histograms with mostly empty bins.
+ *
+ *      Only non-empty cells are stored: an open-addressing hash table maps the
+ *      global ROOT bin number to an index into contiguous sum of weights and
+ *      sum of squared weights arrays. The binning is taken from a ROOT
+ *      histogram (TH2D/TH3F) and the cell numbering is identical to ROOT, so
+ *      content can be merged from and written back to dense histograms.
+ *      It is only used when combining job outputs, histograms are filled
+ *      dense in the event loop.
+ */
+
+#ifndef SPARSEHISTO_H_
+#define SPARSEHISTO_H_
+
+#include <vector>
+#include "Rtypes.h"
+#include "TH1.h"
+
+class SparseHisto {
+public:
+	SparseHisto();
+	virtual ~SparseHisto();
+
+	// take binning (and name) from an existing histogram, content is not copied
+	static SparseHisto Like(const TH1& h);
+
+	void AddBinContent(Long64_t bin, double w, double w2);
+
+	// merge non-empty cells of a dense histogram with identical binning
+	bool Add(const TH1& h, double c = 1.);
+	bool Add(const SparseHisto& o);
+	// write content into a dense histogram with identical binning
+	bool AddTo(TH1& h) const;
+	void Scale(double c);
+	void Reset();
+	void Swap(SparseHisto& o);
+
+	bool     isValid() const {return dim > 0;}
+	unsigned GetNFilled() const {return keys.size();}
+
+private:
+	bool     SameBinning(const TH1& h) const;
+	bool     SameBinning(const SparseHisto& o) const;
+	Long64_t FindSlot(Long64_t bin) const;
+	void     Rehash(unsigned int newSize);
+
+	int dim;
+	int n[3];
+	double entries;
+	double stats[13]; // moments as TH1::GetStats (TH1::kNstat), kept through merging
+
+	// hash table: slot -> index into keys/sumw/sumw2, -1 if empty
+	std::vector<Long64_t> table;
+	std::vector<Long64_t> keys;
+	std::vector<double>   sumw;
+	std::vector<double>   sumw2;
+};
+
+#endif /* SPARSEHISTO_H_ */
@@ -19,6 +19,7 @@ class TauSpinerInterface {
 #ifdef USE_TauSpinner
   double Get(int type, SimpleParticle X, SimpleParticle tau, std::vector<SimpleParticle> tau_daughters,SimpleParticle tau2, std::vector<SimpleParticle> tau_daughters2);
   void SetTauSignalCharge(int tsc){signalcharge=tsc;}
+  int GetTauSignalCharge(){return signalcharge;}
 
  private:
   void Initialize();
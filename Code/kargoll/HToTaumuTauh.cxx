@@ -21,6 +21,9 @@ HToTaumuTauh::HToTaumuTauh(TString Name_, TString id_):
   cTau_rawIso(1.5),
   cMuTau_dR(0.5),
   cTau_dRHltMatch(0.5),
+  cTau_IdMask(Ntuple_Controller::PFTauDiscMask(Ntuple_Controller::PFTauDisc_isHPSByDecayModeFinding) |
+		Ntuple_Controller::PFTauDiscMask(Ntuple_Controller::PFTauDisc_isHPSAgainstElectronsLoose) |
+		Ntuple_Controller::PFTauDiscMask(Ntuple_Controller::PFTauDisc_isHPSAgainstMuonTight)),
   cMuTriLep_pt(10.0),
   cMuTriLep_eta(2.4),
   cEleTriLep_pt(10.0),
@@ -749,15 +752,8 @@ void HToTaumuTauh::doSelection(bool runAnalysisCuts){
 	Logger(Logger::Verbose) << std::endl;
 	// Vertex
 	Logger(Logger::Debug) << "Cut: Vertex" << std::endl;
-	unsigned int nGoodVtx=0;
-	for(unsigned int i_vtx=0;i_vtx<Ntp->NVtx();i_vtx++){
-	  if(Ntp->isGoodVtx(i_vtx)){
-	  	if(selVertex == -1) selVertex = i_vtx; // selected vertex = first vertex (highest sum[pT^2]) to fulfill vertex requirements
-	  	nGoodVtx++;
-	  }
-	}
-
-	value.at(PrimeVtx)=nGoodVtx;
+	selVertex = Ntp->FirstGoodVtx(); // selected vertex = first vertex (highest sum[pT^2]) to fulfill vertex requirements
+	value.at(PrimeVtx)=Ntp->NGoodVtx();
 	pass.at(PrimeVtx)=(value.at(PrimeVtx)>=cut.at(PrimeVtx));
 	originalPass.at(PrimeVtx) = pass.at(PrimeVtx);
 
@@ -1156,69 +1152,50 @@ void HToTaumuTauh::doPlotting(){
 		}
 		h_visibleMassCoarse.at(t).Fill((Ntp->Muon_p4(selMuon) + Ntp->PFTau_p4(selTau)).M(), w);
 		// SVFit
+		// the mass histograms are filled by SVfitFiller, when the result is available (see SVfitPool)
+		double visMass = (Ntp->Muon_p4(selMuon) + Ntp->PFTau_p4(selTau)).M();
+		bool isZL = (HConfig.GetID(t) == DataMCType::DY_ll || HConfig.GetID(t) == DataMCType::DY_ee || HConfig.GetID(t) == DataMCType::DY_mumu);
+		// fits run in SVfitPool workers are timed by the workers, the clock only measures the submission
+		bool asyncTime = SVfitPool::Instance().isAsync() && !SVFitStorage::isRequestMode();
 		clock->Start("SVFit");
 		// get SVFit result from cache
-		SVFitObject *svfObj = Ntp->getSVFitResult_MuTauh(svfitstorage, "CorrMVAMuTau", selMuon, selTau, 50000);
+		Ntp->getSVFitResult_MuTauh(new SVfitFiller(this, SVfitNominal, t, w, visMass, m_Truth, isZL, asyncTime), svfitstorage, "CorrMVAMuTau", selMuon, selTau, 50000);
 		clock->Stop("SVFit");
 
 		// shape distributions for final fit
-		double visMass = (Ntp->Muon_p4(selMuon) + Ntp->PFTau_p4(selTau)).M();
 		h_shape_VisM.at(t).Fill(visMass, w);
-		double svfMass = -999;
-		if (!svfObj->isValid()) {
-			Logger(Logger::Warning) << "SVFit object is invalid. SVFit mass set to -999." << std::endl;
-			h_SVFitStatus.at(t).Fill(1);
-		} else if (svfObj->get_mass() < visMass) {
-			Logger(Logger::Warning) << "SVFit mass " << svfObj->get_mass() << " smaller than visible mass " << visMass << ". SVFit mass SVFit mass set to -999." << std::endl;
-			h_SVFitStatus.at(t).Fill(2);
-		} else {
-			svfMass = svfObj->get_mass();
-			h_SVFitStatus.at(t).Fill(0);
-		}
-
-		h_shape_SVfitM.at(t).Fill(svfMass, w);
-
-		h_SVFitMass.at(t).Fill(svfMass, w);
-		h_SVFitMassCoarse.at(t).Fill(svfMass, w);
-
-		h_SVFitMassResol.at(t).Fill((svfObj->get_mass() - m_Truth) / m_Truth, w);
 		h_visibleMassResol.at(t).Fill((m_Vis - m_Truth) / m_Truth, w);
 
 		// ZL shape uncertainty
-		if (HConfig.GetID(t) == DataMCType::DY_ll || HConfig.GetID(t) == DataMCType::DY_ee || HConfig.GetID(t) == DataMCType::DY_mumu) {
+		if (isZL) {
 			h_shape_VisM_ZLScaleUp.at(t).Fill(1.02 * visMass);
 			h_shape_VisM_ZLScaleDown.at(t).Fill(0.98 * visMass);
-			h_shape_SVfitM_ZLScaleUp.at(t).Fill(1.02 * svfMass);
-			h_shape_SVfitM_ZLScaleDown.at(t).Fill(0.98 * svfMass);
 		}
 
 		// tau energy scale uncertainty
 		TLorentzVector tauP4Up = 1.03 * Ntp->PFTau_p4(selTau);
 		TLorentzVector tauP4Down = 0.97 * Ntp->PFTau_p4(selTau);
+		double visMass_tauESUp = (Ntp->Muon_p4(selMuon) + tauP4Up).M();
+		double visMass_tauEsDown = (Ntp->Muon_p4(selMuon) + tauP4Down).M();
 		clock->Start("SVFitTauESUp");
-		SVFitObject *svfObjTauESUp = Ntp->getSVFitResult_MuTauh(svfitstorTauESUp, "CorrMVAMuTau", selMuon, selTau, 50000, "TauESUp", 1., 1.03);
+		Ntp->getSVFitResult_MuTauh(new SVfitFiller(this, SVfitTauESUp, t, w, visMass_tauESUp, m_Truth, isZL, asyncTime), svfitstorTauESUp, "CorrMVAMuTau", selMuon, selTau, 50000, "TauESUp", 1., 1.03);
 		clock->Stop("SVFitTauESUp");
 		clock->Start("SVFitTauESDown");
-		SVFitObject *svfObjTauESDown = Ntp->getSVFitResult_MuTauh(svfitstorTauESDown, "CorrMVAMuTau", selMuon, selTau, 50000, "TauESDown", 1., 0.97);
+		Ntp->getSVFitResult_MuTauh(new SVfitFiller(this, SVfitTauESDown, t, w, visMass_tauEsDown, m_Truth, isZL, asyncTime), svfitstorTauESDown, "CorrMVAMuTau", selMuon, selTau, 50000, "TauESDown", 1., 0.97);
 		clock->Stop("SVFitTauESDown");
 
-		double visMass_tauESUp = (Ntp->Muon_p4(selMuon) + tauP4Up).M();
-		double visMass_tauEsDown = (Ntp->Muon_p4(selMuon) + tauP4Down).M();
-		double svfMass_tauESUp = (svfObjTauESUp->isValid()) ? svfObjTauESUp->get_mass() : -999.;
-		double svfMass_tauESDown = (svfObjTauESDown->isValid()) ? svfObjTauESDown->get_mass() : -999.;
-
 		h_shape_VisM_TauESUp.at(t).Fill(visMass_tauESUp, w);
 		h_shape_VisM_TauESDown.at(t).Fill(visMass_tauEsDown, w);
-		h_shape_SVfitM_TauESUp.at(t).Fill(svfMass_tauESUp, w);
-		h_shape_SVfitM_TauESDown.at(t).Fill(svfMass_tauESDown, w);
 
-		// timing info on mass reconstruction
-		h_SVFitTimeReal.at(t).Fill(clock->GetRealTime("SVFit"), 1); // filled w/o weight
-		h_SVFitTimeCPU.at(t).Fill(clock->GetCpuTime("SVFit"), 1); // filled w/o weight
-		h_SVFitTimeReal.at(t).Fill(clock->GetRealTime("SVFitTauESUp"), 1); // filled w/o weight
-		h_SVFitTimeCPU.at(t).Fill(clock->GetCpuTime("SVFitTauESUp"), 1); // filled w/o weight
-		h_SVFitTimeReal.at(t).Fill(clock->GetRealTime("SVFitTauESDown"), 1); // filled w/o weight
-		h_SVFitTimeCPU.at(t).Fill(clock->GetCpuTime("SVFitTauESDown"), 1); // filled w/o weight
+		// timing info on mass reconstruction (asynchronous fits: filled by SVfitFiller)
+		if (!asyncTime) {
+			h_SVFitTimeReal.at(t).Fill(clock->GetRealTime("SVFit"), 1); // filled w/o weight
+			h_SVFitTimeCPU.at(t).Fill(clock->GetCpuTime("SVFit"), 1); // filled w/o weight
+			h_SVFitTimeReal.at(t).Fill(clock->GetRealTime("SVFitTauESUp"), 1); // filled w/o weight
+			h_SVFitTimeCPU.at(t).Fill(clock->GetCpuTime("SVFitTauESUp"), 1); // filled w/o weight
+			h_SVFitTimeReal.at(t).Fill(clock->GetRealTime("SVFitTauESDown"), 1); // filled w/o weight
+			h_SVFitTimeCPU.at(t).Fill(clock->GetCpuTime("SVFitTauESDown"), 1); // filled w/o weight
+		}
 
 		// QCD shape uncertainty and scaling to be done on datacard level
 
@@ -1518,6 +1495,42 @@ void HToTaumuTauh::doPlotting(){
 	}
 }
 
+void HToTaumuTauh::fillSVfitHistograms(const SVFitObject& svfObj, svfitVariation var, unsigned t, double w, double visMass, double mTruth, bool isZL){
+	if (var == SVfitTauESUp) {
+		h_shape_SVfitM_TauESUp.at(t).Fill(svfObj.isValid() ? svfObj.get_mass() : -999., w);
+		return;
+	}
+	if (var == SVfitTauESDown) {
+		h_shape_SVfitM_TauESDown.at(t).Fill(svfObj.isValid() ? svfObj.get_mass() : -999., w);
+		return;
+	}
+
+	double svfMass = -999;
+	if (!svfObj.isValid()) {
+		Logger(Logger::Warning) << "SVFit object is invalid. SVFit mass set to -999." << std::endl;
+		h_SVFitStatus.at(t).Fill(1);
+	} else if (svfObj.get_mass() < visMass) {
+		Logger(Logger::Warning) << "SVFit mass " << svfObj.get_mass() << " smaller than visible mass " << visMass << ". SVFit mass SVFit mass set to -999." << std::endl;
+		h_SVFitStatus.at(t).Fill(2);
+	} else {
+		svfMass = svfObj.get_mass();
+		h_SVFitStatus.at(t).Fill(0);
+	}
+
+	h_shape_SVfitM.at(t).Fill(svfMass, w);
+
+	h_SVFitMass.at(t).Fill(svfMass, w);
+	h_SVFitMassCoarse.at(t).Fill(svfMass, w);
+
+	h_SVFitMassResol.at(t).Fill((svfObj.get_mass() - mTruth) / mTruth, w);
+
+	// ZL shape uncertainty
+	if (isZL) {
+		h_shape_SVfitM_ZLScaleUp.at(t).Fill(1.02 * svfMass);
+		h_shape_SVfitM_ZLScaleDown.at(t).Fill(0.98 * svfMass);
+	}
+}
+
 void HToTaumuTauh::Finish() {
 	Logger(Logger::Verbose) << "Start." << std::endl;
 
@@ -1680,13 +1693,8 @@ bool HToTaumuTauh::selectElectron_triLeptonVeto(unsigned i, unsigned i_vtx, std:
 ///////// Taus
 
 bool HToTaumuTauh::selectPFTau_Id(unsigned i){
-	if ( 	Ntp->PFTau_isHPSByDecayModeFinding(i) &&
-			Ntp->PFTau_isHPSAgainstElectronsLoose(i) &&
-			Ntp->PFTau_isHPSAgainstMuonTight(i)
-			){
-		return true;
-	}
-	return false;
+	// decay mode finding, anti-electron loose, anti-muon tight (cTau_IdMask)
+	return Ntp->PFTau_passDiscriminators(i, cTau_IdMask);
 }
 
 bool HToTaumuTauh::selectPFTau_Id(unsigned i, std::vector<int> muonCollection){
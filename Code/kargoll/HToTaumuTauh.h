@@ -11,6 +11,7 @@
 #include "ReferenceScaleFactors.h"
 #include "../DataFormats/SVFitObject.h"
 #include "SVFitStorage.h"
+#include "SVfitPool.h"
 #include "UncertaintyValue.h"
 
 class TLorentzVector;
@@ -259,6 +260,7 @@ class HToTaumuTauh : public Selection {
   // cut values
   double cMu_dxy, cMu_dz, cMu_relIso, cMu_pt, cMu_eta, cMu_dRHltMatch;
   double cTau_pt, cTau_eta, cTau_rawIso, cMuTau_dR, cTau_dRHltMatch;
+  ULong64_t cTau_IdMask; // required tau discriminators, see Ntuple_Controller::PFTauDiscriminator
   double cMuTriLep_pt, cMuTriLep_eta, cEleTriLep_pt, cEleTriLep_eta;
   std::vector<TString> cTriggerNames;
   double cCat_jetPt, cCat_jetEta, cCat_bjetPt, cCat_bjetEta, cCat_btagDisc, cCat_splitTauPt, cJetClean_dR;
@@ -341,6 +343,33 @@ class HToTaumuTauh : public Selection {
   SVFitStorage svfitstorTauESUp;
   SVFitStorage svfitstorTauESDown;
 
+  // fills the SVfit mass histograms of one event, also when the fit is done later in SVfitPool;
+  // with fillTime the SVfit time histograms are filled with the time of the fit (0 if it was not run)
+  enum svfitVariation {SVfitNominal, SVfitTauESUp, SVfitTauESDown};
+  class SVfitFiller : public SVfitPool::Consumer {
+  public:
+	SVfitFiller(HToTaumuTauh* sel, svfitVariation var, unsigned t, double w, double visMass, double mTruth, bool isZL, bool fillTime):
+		sel_(sel), var_(var), t_(t), w_(w), visMass_(visMass), mTruth_(mTruth), isZL_(isZL), fillTime_(fillTime), realTime_(0), cpuTime_(0) {}
+	virtual void FitDone(const SVFitObject& result, const SVfitProvider::FitStats& stats) {realTime_ = stats.realTime; cpuTime_ = stats.cpuTime;}
+	virtual void Consume(const SVFitObject& result) {
+		sel_->fillSVfitHistograms(result, var_, t_, w_, visMass_, mTruth_, isZL_);
+		if (fillTime_) {
+			sel_->h_SVFitTimeReal.at(t_).Fill(realTime_, 1); // filled w/o weight
+			sel_->h_SVFitTimeCPU.at(t_).Fill(cpuTime_, 1); // filled w/o weight
+		}
+	}
+  private:
+	HToTaumuTauh* sel_;
+	svfitVariation var_;
+	unsigned t_;
+	double w_, visMass_, mTruth_;
+	bool isZL_;
+	bool fillTime_;
+	double realTime_, cpuTime_;
+  };
+  friend class SVfitFiller;
+  void fillSVfitHistograms(const SVFitObject& svfObj, svfitVariation var, unsigned t, double w, double visMass, double mTruth, bool isZL);
+
   // timing information
   TBenchmark* clock;
 
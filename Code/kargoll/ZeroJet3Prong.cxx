@@ -318,18 +318,15 @@ void ZeroJet3Prong::categoryPlotting(){
 		TVector3 PV = Ntp->PFTau_TIP_primaryVertex_pos(selTau);
 		TMatrixTSym<double> PVCov = Ntp->PFTau_TIP_primaryVertex_cov(selTau);
 
-		TLorentzVector Recoil;
-		for(unsigned i; i<Ntp->Vtx_nTrk(selVertex); i++){
-			Recoil += Ntp->Vtx_TracksP4(selVertex, i);
-		}
+		TLorentzVector Recoil = Ntp->Vtx_TracksP4Sum(selVertex);
 		Recoil -= Ntp->Muon_p4(selMuon);
 		Recoil -= Ntp->PFTau_p4(selTau);
 		double Phi_Res = (Recoil.Phi() > 0) ? Recoil.Phi() - TMath::Pi() : Recoil.Phi() + TMath::Pi();
 
-		//Logger::Instance()->setLevelForClass("GlobalEventFit", Logger::Debug);
-		GlobalEventFit GEF(MuonTP, A1, Phi_Res, PV, PVCov);
-		TPResults = GEF.getTPTRObject();
-		GEFObject Results = GEF.Fit();
+		// shared with the other categories and systematics of this event
+		const Ntuple_Controller::GEFResult& GEF = Ntp->GlobalEventFit_MuTau3p(MuonTP, A1, Phi_Res, PV, PVCov);
+		TPResults = GEF.first;
+		GEFObject Results = GEF.second;
 
 		// fill plots
 		if (TPResults.isAmbiguous()) {
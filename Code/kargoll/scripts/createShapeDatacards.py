@@ -64,7 +64,7 @@ parser.add_argument('--verbose', action='store_true', help="Print more stuff")
 args = parser.parse_args()
 
 # define template structure of files, histograms, ...
-inFileTemplate = 'LOCAL_COMBINED_<CAT>_default_LumiScaled.root'
+inFileTemplate = 'LOCAL_COMBINED_<CAT>_default.root'
 histoTemplate = '<CAT>_default_<VAR><PROC>'
 outFileTemplate = 'htt_<CHANNEL>.inputs-sm-<DATASET>.root'
 qcdShapeUncTemplate = 'CMS_htt_QCDShape_<CHANNEL>_<CAT>_<DATASET><UPDOWN>'
@@ -114,6 +114,11 @@ for cat in args.categories:
     # read in output from analysis
     inFile = ROOT.TFile(args.inputFolder + '/' + inFileTemplate.replace('<CAT>', cat), "READ")
     
+    # histograms are stored unscaled, lumi scale factors per sample are stored next to them
+    scaleFactors = {}
+    for entry in inFile.Get('LumiScaleFactors'):
+        scaleFactors[str(entry.name).rstrip('\0')] = entry.scale
+    
     # update directory structure in output file
     outFile.cd()
     newDir = outFile.mkdir('muTau_' + translate[cat])
@@ -139,6 +144,7 @@ for cat in args.categories:
             if args.verbose : print 'Loading histogram', histName
             inHist = inFile.Get(histName)
             inHistReb = inHist.Rebin(len(binning[binKey])-1, 'inHistReb', binning[binKey])
+            inHistReb.Scale(scaleFactors.get(sample, 1.0))
             
             
             if sample == "QCD":
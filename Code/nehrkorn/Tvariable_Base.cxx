@@ -120,6 +120,7 @@ Tvariable_Base::~Tvariable_Base(){
 	 << Npassed.at(j).GetBinContent(1)     << " +/- " << Npassed.at(j).GetBinError(1)     << " after: "
 	 << Npassed.at(j).GetBinContent(NCuts+1) << " +/- " << Npassed.at(j).GetBinError(NCuts+1) << std::endl;
   }
+  if(doPDFuncertainty) delete pdf; // stores the computed PDF weights
   std::cout << "Tvariable_Base::~Tvariable_Base()" << std::endl;
 }
 
@@ -526,15 +527,8 @@ void  Tvariable_Base::doEvent(){
   // Vertex selection
   //
   if(verbose)std::cout << "Vertex selection" << std::endl;
-  unsigned int nGoodVtx=0;
-  int vertex = -1;
-  for(unsigned i=0;i<Ntp->NVtx();i++){
-	  if(Ntp->isGoodVtx(i)){
-		  if(vertex==-1)vertex=i;
-		  nGoodVtx++;
-	  }
-  }
-  value.at(PrimeVtx)=nGoodVtx;
+  int vertex = Ntp->FirstGoodVtx();
+  value.at(PrimeVtx)=Ntp->NGoodVtx();
   pass.at(PrimeVtx)=(value.at(PrimeVtx)>=cut.at(PrimeVtx));
 
   ///////////////////////////////////////////////
@@ -1193,11 +1187,13 @@ void  Tvariable_Base::doEvent(){
   //
   if(doPDFuncertainty){
 	  if(verbose) std::cout << "Calculating PDF weights" << std::endl;
-	  for(int member=0;member<nPDFmembers;++member){
-		  if(Ntp->isData() || Ntp->GetMCID()==DataMCType::QCD) break;
-		  double pdfWeight = w*pdf->weight(Ntp->GenEventInfoProduct_id1(),Ntp->GenEventInfoProduct_id2(),Ntp->GenEventInfoProduct_x1(),Ntp->GenEventInfoProduct_x2(),Ntp->GenEventInfoProduct_scalePDF(),member);
-		  pdf_w0.at(t).AddBinContent(member+1,pdfWeight);
-		  if(status) pdf_w1.at(t).AddBinContent(member+1,pdfWeight);
+	  if(!Ntp->isData() && Ntp->GetMCID()!=DataMCType::QCD){
+		  const std::vector<double>& pdfWeights = pdf->weights(Ntp->RunNumber(),Ntp->LuminosityBlock(),Ntp->EventNumber(),Ntp->GenEventInfoProduct_id1(),Ntp->GenEventInfoProduct_id2(),Ntp->GenEventInfoProduct_x1(),Ntp->GenEventInfoProduct_x2(),Ntp->GenEventInfoProduct_scalePDF());
+		  for(int member=0;member<nPDFmembers;++member){
+			  double pdfWeight = w*pdfWeights.at(member);
+			  pdf_w0.at(t).AddBinContent(member+1,pdfWeight);
+			  if(status) pdf_w1.at(t).AddBinContent(member+1,pdfWeight);
+		  }
 	  }
   }
 
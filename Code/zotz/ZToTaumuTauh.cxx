@@ -21,7 +21,10 @@ ZToTaumuTauh::ZToTaumuTauh(TString Name_, TString id_):
   cTau_eta(2.3),
   cMuTau_dR(0.3),
   cTau_IsoRaw(1.5),
-  cTau_dRHltMatch(0.5)
+  cTau_dRHltMatch(0.5),
+  cTau_IdMask(Ntuple_Controller::PFTauDiscMask(Ntuple_Controller::PFTauDisc_isHPSByDecayModeFinding) |
+		Ntuple_Controller::PFTauDiscMask(Ntuple_Controller::PFTauDisc_isHPSAgainstElectronsLoose) |
+		Ntuple_Controller::PFTauDiscMask(Ntuple_Controller::PFTauDisc_isHPSAgainstMuonTight))
 {
 	TString trigNames[] = {"HLT_IsoMu18_eta2p1_LooseIsoPFTau20","HLT_IsoMu17_eta2p1_LooseIsoPFTau20"};
 	std::vector<TString> temp (trigNames, trigNames + sizeof(trigNames) / sizeof(TString) );
@@ -1361,13 +1364,8 @@ bool ZToTaumuTauh::selectMuon_AntiIsolation(unsigned i){
 
 ///////// Taus
 bool ZToTaumuTauh::selectPFTau_Id(unsigned i){
-	if ( 	Ntp->PFTau_isHPSByDecayModeFinding(i) &&
-			Ntp->PFTau_isHPSAgainstElectronsLoose(i) &&
-			Ntp->PFTau_isHPSAgainstMuonTight(i)
-			){
-		return true;
-	}
-	return false;
+	// decay mode finding, anti-electron loose, anti-muon tight (cTau_IdMask)
+	return Ntp->PFTau_passDiscriminators(i, cTau_IdMask);
 }
 bool ZToTaumuTauh::selectPFTau_Id(unsigned i, std::vector<int> muonCollection){
 	// check if tau is matched to a muon, if so this is not a good tau
@@ -38,6 +38,7 @@ class ZToTaumuTauh : public Selection {
   // cut values
   double cMu_dxy, cMu_dz, cMu_relIso, cMu_pt, cMu_eta, cMu_dRHltMatch;
   double cTau_pt, cTau_eta, cMuTau_dR, cTau_IsoRaw, cTau_dRHltMatch;
+  ULong64_t cTau_IdMask; // required tau discriminators, see Ntuple_Controller::PFTauDiscriminator
   std::vector<TString> cTriggerNames;
 
   double OneProngNoPiWeight;